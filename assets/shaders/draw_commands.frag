@@ -0,0 +1,9 @@
+#version 460 core
+
+in vec4 fColor;
+out vec4 color;
+
+void main()
+{
+    color = fColor;
+}
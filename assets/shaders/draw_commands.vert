@@ -0,0 +1,22 @@
+#version 460 core
+
+layout (location = 0) in vec4 vPos;
+layout (location = 1) in vec4 vColor;
+out vec4 fColor;
+
+// matrices are row major on the C++ side
+layout (std140, row_major, binding = 0) uniform Frame
+{
+    mat4 projection;
+};
+
+layout (std140, row_major, binding = 1) uniform Draw
+{
+    mat4 model;
+};
+
+void main()
+{
+    fColor = vColor;
+    gl_Position = projection * (model * vPos);
+}
@@ -0,0 +1,9 @@
+#version 460 core
+
+in vec3 fColor;
+out vec4 color;
+
+void main()
+{
+    color = vec4(fColor, 1.0f);
+}
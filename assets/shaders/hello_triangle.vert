@@ -0,0 +1,11 @@
+#version 460 core
+
+void main()
+{
+    vec2 points[3] = vec2[3](
+        vec2(-0.7, -0.7),
+        vec2(0.0, 0.7),
+        vec2(0.7, -0.7)
+    );
+    gl_Position = vec4(points[gl_VertexID], 0.0, 1.0);
+}
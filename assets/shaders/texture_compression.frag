@@ -0,0 +1,17 @@
+#version 460 core
+
+in vec2 texcoord;
+out vec4 color;
+uniform float edge;
+uniform sampler2D tex0;
+uniform sampler2D tex1;
+
+void main()
+{
+    float fragX = gl_FragCoord.x;
+    float c = step(edge, gl_FragCoord.x);
+    vec4 color0 = texture(tex0, texcoord);
+    vec4 color1 = texture(tex1, texcoord);
+    float inRange = step(edge - 0.5, fragX) * step(fragX, edge + 0.49);
+    color = mix(color0 * (1 - c) + color1 * c, vec4(0.0, 0.0, 0.0, 1.0), inRange);
+}
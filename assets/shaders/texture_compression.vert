@@ -0,0 +1,16 @@
+#version 460 core
+
+out vec2 texcoord;
+uniform mat4 proj;
+
+void main()
+{
+    vec2 points[4] = vec2[](
+        vec2(-1.0f, -1.0f),
+        vec2(-1.0f,  1.0f),
+        vec2( 1.0f,  1.0f),
+        vec2( 1.0f, -1.0f)
+    );
+    gl_Position = proj * vec4(points[gl_VertexID], 0.0, 1.0);
+    texcoord = (points[gl_VertexID] + 1.0) / 2;
+}
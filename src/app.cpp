@@ -1,5 +1,21 @@
 #include "app.h"
+#include "benchmark.h"
 #include "canvas/canvas.h"
+#include "canvas/main_canvas.h"
+#include "frame_pacer.h"
+#include "frame_stats.h"
+#include "gl/call_counter.h"
+#include "gl/framework.h"
+#include "gl/gpu_timer.h"
+#include "gl/program_cache.h"
+#include "gl/render_target.h"
+#include "gl/shader_library.h"
+#include "gl/uniform_arena.h"
+#include "gl/validation.h"
+#include "gl/upload_service.h"
+#include "render_thread.h"
+#include "ui/frame_stats_overlay.h"
+#include "worker_pool.h"
 
 #include <glad/glad.h>
 #include <imgui.h>
@@ -10,19 +26,87 @@
 #include "./backends/imgui_impl_opengl3.h"
 #include "./backends/imgui_impl_sdl3.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace {
+// how often fences of finished uploads are checked while the loop is idle
+constexpr uint64_t UploadPollInterval = SDL_MS_TO_NS(4);
+// how often an idle loop looks for changed shader files
+constexpr uint64_t ShaderWatchInterval = SDL_MS_TO_NS(250);
+// grows on demand, see StreamBuffer
+constexpr GLsizeiptr UniformArenaRegionSize = 64 * 1024;
+
+enum GpuScope
+{
+    GpuScopeRender,
+    GpuScopeRenderUI,
+    GpuScopeCount
+};
+
 struct WindowInfo
 {
     SDL_Window*   window;
     ImGuiContext* imguiContext;
     Canvas*       canvas;
+    FramePacer    pacer;
+    int           swapInterval = -1; // last value set for this window
+
+    std::shared_ptr<FrameStats>   stats;
+    std::shared_ptr<GL::GpuTimer> gpuTimer; // null if timer queries are unsupported
+    std::shared_ptr<GL::RenderTarget> renderTarget; // headless/composite only
+};
+
+// A window that renders in the current iteration of the loop.
+struct PendingFrame
+{
+    WindowInfo* wi;
+    uint64_t    start;
+    uint64_t    newFrameNs = 0; // time spent in the backends' NewFrame
+    uint64_t    buildUINs = 0;  // Canvas::BuildUI, FinishUI adds ImGui::Render
+    int         width = 0; // window size in pixels
+    int         height = 0;
+
+    std::function<void()> render; // Canvas::RecordRender()
+};
+
+// Copy of a context's draw data that stays valid after its next
+// ImGui::NewFrame(), so the UI can be rendered on the render thread.
+class DrawDataCopy
+{
+public:
+    explicit DrawDataCopy(const ImDrawData* source)
+        : data_(*source)
+    {
+        for (auto& list : data_.CmdLists) {
+            list = list->CloneOutput();
+        }
+    }
+    ~DrawDataCopy()
+    {
+        for (auto* list : data_.CmdLists) {
+            IM_DELETE(list);
+        }
+    }
+    DrawDataCopy(const DrawDataCopy&) = delete;
+    DrawDataCopy& operator=(const DrawDataCopy&) = delete;
+
+    ImDrawData* Get() { return &data_; }
+
+private:
+    ImDrawData data_;
 };
 
 class AppImpl
@@ -42,11 +126,32 @@ public:
     void InitPlatform();
     void InitRenderer();
     void InitUI();
-
-    int  Loop();
-    bool ProcessEvents();
+    void InitBenchmark();
+
+    int      Loop();
+    uint64_t GetNextFrameDeadline() const;
+    bool     ProcessEvents(uint64_t deadline);
+    bool DispatchEvent(SDL_Event& event);
+    void CoalesceMouseMotion(const SDL_Event& event);
+    void FlushMouseMotion();
+    void RouteEvent(SDL_Event& event);
     void ProcessEvent(WindowInfo& wi, SDL_Event& event);
     void UpdateWindows();
+    void PollUploads();
+    void PollShaders();
+    void BeginFrame(PendingFrame& frame);
+    void BuildFrames();
+    void StartUI(PendingFrame& frame);
+    void BuildUI(PendingFrame& frame);
+    void FinishUI(PendingFrame& frame);
+    RenderThread::Packet RecordWindow(PendingFrame& frame, bool sync);
+    RenderThread::Packet RecordPresent(PendingFrame& frame, int swapInterval);
+    RenderThread::Packet RecordFrameWait();
+
+    // Borrows the GL context from the render thread (no-op without one),
+    // calls nest.
+    void AcquireGL();
+    void ReleaseGL();
 
     void Shutdown();
     void ShutdownPlatform();
@@ -59,15 +164,88 @@ public:
     void CloseAllWindows();
     void ProcessWindowsCreateQueue();
     void ProcessWindowsDestroyQueue();
+    void DestroyWindow(WindowInfo& wi);
+
+    void SetContinuous(bool continuous) { continuous_ = continuous; }
+    bool IsContinuous() const { return continuous_; }
+    void SetStatsOverlay(bool shown) { statsOverlay_ = shown; }
+    bool IsStatsOverlayShown() const { return statsOverlay_; }
+    bool IsHeadless() const { return headless_; }
+    void SetPresentMode(App::PresentMode mode) { presentMode_ = mode; }
+    App::PresentMode GetPresentMode() const { return presentMode_; }
+    bool IsBenchmark() const { return benchmark_ != nullptr; }
+    const GL::FrameFences* GetFrameFences() const { return frameFences_.get(); }
+    GL::UploadService* GetUploadService() { return uploadService_.get(); }
+    GL::ShaderLibrary* GetShaderLibrary() { return shaderLibrary_.get(); }
+
+    WindowInfo*       FindWindow(Canvas* canvas);
+    const WindowInfo* FindWindow(Canvas* canvas) const;
 
 private:
     SDL_Window*   fakeWindow_ = nullptr;
     SDL_GLContext glContext_;
     ImFontAtlas*  fontAtlas_ = nullptr;
+    bool          continuous_ = false;
+    bool          statsOverlay_ = false;
+
+    // headless mode renders into offscreen targets of windowWidth_ x
+    // windowHeight_ and never presents, readback_ copies every frame back
+    bool headless_ = false;
+    bool readback_ = false;
+    int  windowWidth_ = 1280;
+    int  windowHeight_ = 720;
+
+    FramePacer::Mode defaultPacing_ = FramePacer::Mode::Display;
+    double           defaultRate_ = FramePacer::DefaultRate;
+
+    // --bench runs a single canvas for a fixed number of frames and quits
+    std::unique_ptr<Benchmark> benchmark_;
+    Canvas*                    benchCanvas_ = nullptr;
+
+    App::PresentMode presentMode_ = App::PresentMode::VSyncLast;
 
     std::unordered_map<Canvas*, WindowInfo> windows_;
+    std::unordered_map<SDL_WindowID, WindowInfo*> windowIds_; // into windows_
+    std::optional<SDL_Event> pendingMotion_;
+    uint64_t                 coalescedEvents_ = 0;
+    std::vector<PendingFrame>               pendingFrames_;
+    std::vector<PendingFrame*>              parallelFrames_;
+
+    // --render-thread submits GL work through a queue of --render-queue
+    // frames, the render thread owns the context while the loop runs
+    bool                          renderThreadEnabled_ = false;
+    int                           renderQueueDepth_ = 2;
+    std::unique_ptr<RenderThread> renderThread_;
+    int                           glAcquired_ = 0;
+
+    // bounds how far the CPU runs ahead of the GPU, --frames-in-flight N
+    int                              framesInFlight_ = 2;
+    std::unique_ptr<GL::FrameFences> frameFences_;
+
+    // per frame constants of the canvases, a region per frame in flight
+    std::unique_ptr<GL::UniformArena> uniformArena_;
+
+    // decodes and uploads textures/buffers on a shared context
+    std::unique_ptr<GL::UploadService> uploadService_;
+
+    // linked program binaries, --program-cache <dir|off>
+    std::string                       programCacheDir_ = "program_cache";
+    std::unique_ptr<GL::ProgramCache> programCache_;
+
+    // file based shaders, --shader-reload on|off; off by default, watching
+    // wakes an idle loop every ShaderWatchInterval
+    bool                               shaderReload_ = false;
+
+    // GL error checking, --gl-validation off|async|sync|full; canvases may
+    // raise it for themselves
+    GL::Validation glValidation_ = GL::Validation::Off;
+    std::unique_ptr<GL::ShaderLibrary> shaderLibrary_;
+
+    // builds the UI of thread safe canvases, null with --ui-threads 0
+    std::unique_ptr<WorkerPool> workerPool_;
+    int                         uiThreads_ = -1; // -1 - pick from core count
     std::vector<WindowInfo> windowsCreateQueue_;
-    std::vector<WindowInfo> windowsDestroyQueue_;
+    std::vector<Canvas*>    windowsDestroyQueue_;
 
     friend class App;
 };
@@ -94,6 +272,82 @@ static void DestroyPlatformWindow(SDL_Window* window)
     SDL_DestroyWindow(window);
 }
 
+// Window the event is addressed to, 0 for events without one.
+static SDL_WindowID GetEventWindowID(const SDL_Event& event)
+{
+    switch (event.type) {
+    case SDL_EVENT_KEY_DOWN:
+    case SDL_EVENT_KEY_UP:
+        return event.key.windowID;
+    case SDL_EVENT_TEXT_EDITING:
+        return event.edit.windowID;
+    case SDL_EVENT_TEXT_INPUT:
+        return event.text.windowID;
+    case SDL_EVENT_MOUSE_MOTION:
+        return event.motion.windowID;
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+        return event.button.windowID;
+    case SDL_EVENT_MOUSE_WHEEL:
+        return event.wheel.windowID;
+    case SDL_EVENT_DROP_FILE:
+    case SDL_EVENT_DROP_TEXT:
+    case SDL_EVENT_DROP_BEGIN:
+    case SDL_EVENT_DROP_COMPLETE:
+    case SDL_EVENT_DROP_POSITION:
+        return event.drop.windowID;
+    default:
+        if (event.type >= SDL_EVENT_WINDOW_FIRST
+            && event.type <= SDL_EVENT_WINDOW_LAST) {
+            return event.window.windowID;
+        }
+        return 0;
+    }
+}
+
+// Events without a window that every context has to see.
+static bool IsGlobalEvent(const SDL_Event& event)
+{
+    if (event.type >= SDL_EVENT_DISPLAY_FIRST
+        && event.type <= SDL_EVENT_DISPLAY_LAST) {
+        return true;
+    }
+    switch (event.type) {
+    case SDL_EVENT_QUIT:
+    case SDL_EVENT_KEYMAP_CHANGED:
+    case SDL_EVENT_CLIPBOARD_UPDATE:
+    case SDL_EVENT_SYSTEM_THEME_CHANGED:
+    case SDL_EVENT_LOCALE_CHANGED:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static double GetDisplayRefreshRate(SDL_Window* window)
+{
+    const auto* mode
+        = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window));
+    if (!mode) {
+        return 0.0;
+    }
+    if (mode->refresh_rate_numerator > 0 && mode->refresh_rate_denominator > 0) {
+        return (double)mode->refresh_rate_numerator
+            / mode->refresh_rate_denominator;
+    }
+    return mode->refresh_rate;
+}
+
+static void LogPacingStats(const WindowInfo& wi)
+{
+    const auto& stats = wi.pacer.GetStats();
+    SPDLOG_INFO("canvas {}: pacing={} rate={:.2f}Hz frames={} missed={} "
+                "late={} worst lateness={:.3f}ms",
+                (void*)wi.canvas, ToString(wi.pacer.GetMode()),
+                wi.pacer.GetRate(), stats.frames, stats.missed,
+                stats.lateFrames, stats.worstLatenessNs / 1e6);
+}
+
 static SDL_GLContext CreateGLContext(SDL_Window* window)
 {
     SDL_GLContext glContext = SDL_GL_CreateContext(window);
@@ -109,6 +363,20 @@ static void DestroyGLContext(SDL_GLContext glContext)
     SDL_GL_DestroyContext(glContext);
 }
 
+// Distance field glyphs are rasterized larger than shown so they can be
+// scaled up for high density displays without rebuilding the atlas.
+constexpr float FontSize = 24.0f;
+constexpr float SdfFontOversampling = 2.0f;
+
+static float GetFontScale(SDL_Window* window)
+{
+    if (ImGuiGLGetFontAtlasMode() != ImGuiGLFontAtlasMode::Sdf) {
+        return 1.0f;
+    }
+    const float displayScale = SDL_GetWindowDisplayScale(window);
+    return (displayScale > 0.0f ? displayScale : 1.0f) / SdfFontOversampling;
+}
+
 static ImGuiContext* CreateImGuiContext(SDL_Window*      window,
                                         SDL_GLContext    glContext,
                                         ImFontAtlas*     fontAtlas,
@@ -123,6 +391,7 @@ static ImGuiContext* CreateImGuiContext(SDL_Window*      window,
     io.IniFilename = iniFilename.data();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+    io.FontGlobalScale = GetFontScale(window);
     ImGui::StyleColorsLight();
     ImGuiSDL3InitForOpenGL(window, glContext);
     ImGuiGLInitContext();
@@ -153,7 +422,122 @@ AppImpl::AppImpl(int argc, char** argv) { ParseCmdArgs(argc, argv); }
 
 AppImpl::~AppImpl() { }
 
-void AppImpl::ParseCmdArgs(int argc, char** argv) { }
+void AppImpl::ParseCmdArgs(int argc, char** argv)
+{
+    bool              pacingSet = false;
+    bool              bench = false;
+    Benchmark::Config benchConfig;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--bench" && i + 1 < argc) {
+            bench = true;
+            benchConfig.canvas = argv[++i];
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            benchConfig.warmupFrames = std::atoi(argv[++i]);
+        } else if (arg == "--frames" && i + 1 < argc) {
+            benchConfig.frames = std::atoi(argv[++i]);
+        } else if (arg == "--vsync" && i + 1 < argc) {
+            benchConfig.vsync = std::string_view(argv[++i]) == "on";
+        } else if (arg == "--report" && i + 1 < argc) {
+            benchConfig.reportPath = argv[++i];
+        } else if (arg == "--headless") {
+            headless_ = true;
+        } else if (arg == "--readback") {
+            readback_ = true;
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &windowWidth_, &windowHeight_)
+                != 2) {
+                SPDLOG_ERROR("--size expects WxH, got '{}'", argv[i]);
+                windowWidth_ = 1280;
+                windowHeight_ = 720;
+            }
+        } else if (arg == "--present" && i + 1 < argc) {
+            // sequential | vsync-last | composite
+            std::string_view value = argv[++i];
+            if (value == "sequential") {
+                presentMode_ = App::PresentMode::Sequential;
+            } else if (value == "vsync-last") {
+                presentMode_ = App::PresentMode::VSyncLast;
+            } else if (value == "composite") {
+                presentMode_ = App::PresentMode::Composite;
+            } else {
+                SPDLOG_ERROR("unknown --present mode '{}'", value);
+            }
+        } else if (arg == "--render-thread") {
+            renderThreadEnabled_ = true;
+        } else if (arg == "--render-queue" && i + 1 < argc) {
+            renderQueueDepth_ = std::max(std::atoi(argv[++i]), 1);
+        } else if (arg == "--ui-batching" && i + 1 < argc) {
+            // on | off
+            ImGuiGLSetBatching(std::string_view(argv[++i]) != "off");
+        } else if (arg == "--font-atlas" && i + 1 < argc) {
+            // rgba | r8 | sdf
+            std::string_view value = argv[++i];
+            if (value == "rgba") {
+                ImGuiGLSetFontAtlasMode(ImGuiGLFontAtlasMode::RGBA32);
+            } else if (value == "r8") {
+                ImGuiGLSetFontAtlasMode(ImGuiGLFontAtlasMode::Alpha8);
+            } else if (value == "sdf") {
+                ImGuiGLSetFontAtlasMode(ImGuiGLFontAtlasMode::Sdf);
+            } else {
+                SPDLOG_ERROR("unknown --font-atlas mode '{}'", value);
+            }
+        } else if (arg == "--program-cache" && i + 1 < argc) {
+            // <directory> | off
+            programCacheDir_ = argv[++i];
+            if (programCacheDir_ == "off") {
+                programCacheDir_.clear();
+            }
+        } else if (arg == "--shader-reload" && i + 1 < argc) {
+            // on | off
+            shaderReload_ = std::string_view(argv[++i]) == "on";
+        } else if (arg == "--gl-validation" && i + 1 < argc) {
+            // off | async | sync | full
+            std::string_view value = argv[++i];
+            if (!GL::ParseValidation(value, glValidation_)) {
+                SPDLOG_ERROR("unknown --gl-validation tier '{}'", value);
+            }
+        } else if (arg == "--frames-in-flight" && i + 1 < argc) {
+            framesInFlight_ = std::atoi(argv[++i]);
+        } else if (arg == "--ui-threads" && i + 1 < argc) {
+            uiThreads_ = std::atoi(argv[++i]);
+        } else if (arg == "--continuous") {
+            continuous_ = true;
+        } else if (arg == "--stats") {
+            statsOverlay_ = true;
+        } else if (arg == "--pacing" && i + 1 < argc) {
+            // display | vsync | uncapped | <rate in Hz>
+            std::string_view value = argv[++i];
+            pacingSet = true;
+            if (value == "display") {
+                defaultPacing_ = FramePacer::Mode::Display;
+            } else if (value == "vsync") {
+                defaultPacing_ = FramePacer::Mode::VSync;
+            } else if (value == "uncapped") {
+                defaultPacing_ = FramePacer::Mode::Uncapped;
+            } else {
+                defaultPacing_ = FramePacer::Mode::Fixed;
+                defaultRate_ = std::atof(argv[i]);
+            }
+        }
+    }
+
+    if (headless_ && !pacingSet) {
+        // nothing to sync to without a display, run at full speed
+        defaultPacing_ = FramePacer::Mode::Uncapped;
+    }
+
+    if (bench) {
+        // every frame is measured, pacing is reduced to vsync on or off
+        continuous_ = true;
+        defaultPacing_ = benchConfig.vsync ? FramePacer::Mode::VSync
+                                           : FramePacer::Mode::Uncapped;
+        benchConfig.width = windowWidth_;
+        benchConfig.height = windowHeight_;
+        benchConfig.headless = headless_;
+        benchmark_ = std::make_unique<Benchmark>(std::move(benchConfig));
+    }
+}
 
 void AppImpl::Init()
 {
@@ -162,6 +546,7 @@ void AppImpl::Init()
     InitRenderer();
     InitUI();
     NFD_Init();
+    InitBenchmark();
 }
 
 void AppImpl::InitLogger()
@@ -173,11 +558,20 @@ void AppImpl::InitLogger()
 
 void AppImpl::InitPlatform()
 {
+    if (headless_) {
+        // windows without a display, GL goes through EGL pbuffers/surfaceless
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    }
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         SPDLOG_ERROR("SDL_Init(): %s\n", SDL_GetError());
         exit(1);
     }
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
+    // debug output works without a debug context too, but drivers report
+    // more with one
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS,
+                        glValidation_ != GL::Validation::Off
+                            ? SDL_GL_CONTEXT_DEBUG_FLAG
+                            : 0);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
                         SDL_GL_CONTEXT_PROFILE_CORE);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
@@ -210,54 +604,249 @@ void AppImpl::InitRenderer()
         SDL_Quit();
         exit(1);
     }
+    if (benchmark_) {
+        GL::InstallCallCounters();
+    }
 
     SDL_GL_SetSwapInterval(1);
+    GL::SetValidation(glValidation_);
+    SPDLOG_INFO("gl validation: {}", GL::ToString(glValidation_));
+    SPDLOG_INFO("parallel shader compile: {}",
+                GL::EnableParallelShaderCompile() ? "on" : "unsupported");
+    if (!programCacheDir_.empty()) {
+        // before the first program, the UI's own are created in InitUI()
+        programCache_ = std::make_unique<GL::ProgramCache>(programCacheDir_);
+        GL::SetProgramCache(programCache_.get());
+    }
+    frameFences_ = std::make_unique<GL::FrameFences>(framesInFlight_);
+    GL::GetDeletionQueue().SetFrameFences(frameFences_.get());
+    uniformArena_ = std::make_unique<GL::UniformArena>(
+        UniformArenaRegionSize, frameFences_->GetDepth());
+    GL::SetUniformArena(uniformArena_.get());
+    uploadService_ = std::make_unique<GL::UploadService>();
+    shaderLibrary_
+        = std::make_unique<GL::ShaderLibrary>("./assets/shaders", shaderReload_);
 }
 
 void AppImpl::InitUI()
 {
+    // Shared by all contexts, including those built on the worker pool. It
+    // is fully built here, before the first frame; afterwards contexts only
+    // read glyphs. ImGui::NewFrame()/Render() toggle its Locked flag, they
+    // only run on the main thread (see BuildFrames()).
     fontAtlas_ = new ImFontAtlas();
     fontAtlas_->Clear();
-    fontAtlas_->AddFontFromFileTTF("../externals/imgui/misc/fonts/Cousine-Regular.ttf", 24);
+    ImGuiGLPrepareFontAtlas(fontAtlas_);
+    const float fontSize = ImGuiGLGetFontAtlasMode() == ImGuiGLFontAtlasMode::Sdf
+        ? FontSize * SdfFontOversampling
+        : FontSize;
+    fontAtlas_->AddFontFromFileTTF("../externals/imgui/misc/fonts/Cousine-Regular.ttf", fontSize);
     fontAtlas_->Build();
-    ImGuiGLInit();
+    ImGuiGLInit(frameFences_->GetDepth());
+
+    if (uiThreads_ < 0) {
+        // the main thread takes part in every batch
+        const auto cores = (int)std::thread::hardware_concurrency();
+        uiThreads_ = std::clamp(cores - 1, 0, 7);
+    }
+    if (uiThreads_ > 0) {
+        workerPool_ = std::make_unique<WorkerPool>(uiThreads_);
+    }
+}
+
+void AppImpl::InitBenchmark()
+{
+    if (!benchmark_) {
+        return;
+    }
+
+    const auto& name = benchmark_->GetConfig().canvas;
+    benchCanvas_ = MainCanvas::CreateExample(name);
+    if (!benchCanvas_) {
+        SPDLOG_ERROR("Unknown canvas '{}', available:", name);
+        const auto titles = MainCanvas::GetExampleTitles();
+        for (size_t i = 0; i < titles.size(); ++i) {
+            SPDLOG_ERROR("  {}: {}", i, titles[i]);
+        }
+        SDL_Quit();
+        exit(1);
+    }
+    OpenWindow(benchCanvas_);
 }
 
 int AppImpl::Loop()
 {
     bool done = false;
-    
-    constexpr uint8_t frameLength = 16; // ~60Hz
-    uint64_t nextFrameStart = SDL_GetTicks() + frameLength;
+
+    if (renderThreadEnabled_) {
+        SDL_GL_MakeCurrent(nullptr, nullptr);
+        renderThread_ = std::make_unique<RenderThread>(renderQueueDepth_);
+    }
 
     while (!done) {
         ProcessWindowsCreateQueue();
         ProcessWindowsDestroyQueue();
-        done = ProcessEvents();
+        done = ProcessEvents(continuous_ ? 0 : GetNextFrameDeadline());
+        PollUploads();
+        PollShaders();
+        UpdateWindows();
+    }
 
-        auto t = SDL_GetTicks();
-        if (t > nextFrameStart) {
-            nextFrameStart += frameLength;
-            UpdateWindows();
-        }
+    if (renderThread_) {
+        const auto& stats = renderThread_->GetStats();
+        SPDLOG_INFO("render thread: packets={} queue full={} ({:.3f}ms) "
+                    "handoffs={}",
+                    stats.packets, stats.fullWaits, stats.fullWaitNs / 1e6,
+                    stats.handoffs);
+        renderThread_.reset();
+        SDL_GL_MakeCurrent(fakeWindow_, glContext_);
+    }
+
+    const auto& fenceStats = frameFences_->GetStats();
+    SPDLOG_INFO("frames in flight={}: frames={} waited={} ({:.3f}ms, max "
+                "{:.3f}ms)",
+                frameFences_->GetDepth(), fenceStats.frames.load(),
+                fenceStats.waits.load(), fenceStats.waitNs.load() / 1e6,
+                fenceStats.maxWaitNs.load() / 1e6);
+
+    const auto& validationStats = GL::GetValidationStats();
+    SPDLOG_INFO("gl validation: messages={} duplicates={} call errors={}",
+                validationStats.messages.load(),
+                validationStats.duplicates.load(),
+                validationStats.callErrors.load());
+
+    if (programCache_) {
+        const auto& cacheStats = programCache_->GetStats();
+        const auto  hits = cacheStats.hits.load();
+        const auto  lookups = hits + cacheStats.misses.load();
+        SPDLOG_INFO("program cache: hits={}/{} ({:.0f}%) rejected={} "
+                    "load={:.3f}ms compile={:.3f}ms saved={:.3f}ms",
+                    hits, lookups, lookups ? 100.0 * hits / lookups : 0.0,
+                    cacheStats.rejected.load(), cacheStats.loadNs.load() / 1e6,
+                    cacheStats.compileNs.load() / 1e6,
+                    cacheStats.savedNs.load() / 1e6);
     }
 
     return 0;
 }
 
-bool AppImpl::ProcessEvents()
+uint64_t AppImpl::GetNextFrameDeadline() const
+{
+    auto deadline = std::numeric_limits<uint64_t>::max();
+    for (const auto& window : windows_) {
+        if (window.second.canvas->NeedsRedraw()) {
+            deadline = std::min(deadline, window.second.pacer.GetDeadline());
+        }
+    }
+    if (uploadService_->HasPending()) {
+        // nothing wakes the loop when an upload fence signals
+        deadline = std::min(deadline, SDL_GetTicksNS() + UploadPollInterval);
+    }
+    if (shaderLibrary_->HasPending()) {
+        deadline = std::min(deadline, SDL_GetTicksNS() + UploadPollInterval);
+    } else if (shaderLibrary_->IsWatching()) {
+        deadline = std::min(deadline, SDL_GetTicksNS() + ShaderWatchInterval);
+    }
+    return deadline;
+}
+
+// Blocks until either an event arrives or the deadline (SDL_GetTicksNS()
+// nanoseconds) is reached, then drains whatever is left in the queue.
+// A deadline in the past turns this into a plain poll, the maximum value
+// waits for the next event without timeout.
+bool AppImpl::ProcessEvents(uint64_t deadline)
 {
     bool      done = false;
     SDL_Event event;
+
+    const auto now = SDL_GetTicksNS();
+    if (deadline > now) {
+        const auto remaining = deadline - now;
+        Sint32     timeoutMs = -1;
+        if (deadline != std::numeric_limits<uint64_t>::max()) {
+            timeoutMs = (Sint32)std::min<uint64_t>(SDL_NS_TO_MS(remaining),
+                                                   INT32_MAX);
+        }
+        if (timeoutMs == 0) {
+            // SDL_WaitEventTimeout has millisecond granularity, spend the
+            // last fraction of a millisecond in a precise delay instead
+            SDL_DelayPrecise(remaining);
+        } else if (SDL_WaitEventTimeout(&event, timeoutMs)) {
+            done |= DispatchEvent(event);
+        }
+    }
     while (SDL_PollEvent(&event)) {
+        done |= DispatchEvent(event);
+    }
+    FlushMouseMotion();
+    return done;
+}
+
+bool AppImpl::DispatchEvent(SDL_Event& event)
+{
+    if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_F3
+        && !event.key.repeat) {
+        statsOverlay_ = !statsOverlay_;
         for (auto& window : windows_) {
-            ProcessEvent(window.second, event);
+            window.second.canvas->RequestRedraw();
         }
-        if (event.type == SDL_EVENT_QUIT) {
-            done = true;
+    }
+
+    if (event.type == SDL_EVENT_MOUSE_MOTION) {
+        CoalesceMouseMotion(event);
+        return false;
+    }
+    // keep the order, a click has to see the motion that preceded it
+    FlushMouseMotion();
+    RouteEvent(event);
+    return event.type == SDL_EVENT_QUIT;
+}
+
+// ImGui only needs the latest position, consecutive motion events of a
+// window collapse into one with the accumulated relative motion.
+void AppImpl::CoalesceMouseMotion(const SDL_Event& event)
+{
+    if (pendingMotion_
+        && pendingMotion_->motion.windowID == event.motion.windowID
+        && pendingMotion_->motion.which == event.motion.which) {
+        const auto xrel = pendingMotion_->motion.xrel + event.motion.xrel;
+        const auto yrel = pendingMotion_->motion.yrel + event.motion.yrel;
+        pendingMotion_ = event;
+        pendingMotion_->motion.xrel = xrel;
+        pendingMotion_->motion.yrel = yrel;
+        ++coalescedEvents_;
+        return;
+    }
+    FlushMouseMotion();
+    pendingMotion_ = event;
+}
+
+void AppImpl::FlushMouseMotion()
+{
+    if (pendingMotion_) {
+        auto event = *pendingMotion_;
+        pendingMotion_.reset();
+        RouteEvent(event);
+    }
+}
+
+// Window scoped events go to their owner only, events of windows we do not
+// track (the fake window, windows still in the create queue) are dropped.
+void AppImpl::RouteEvent(SDL_Event& event)
+{
+    const auto windowID = GetEventWindowID(event);
+    if (windowID) {
+        auto it = windowIds_.find(windowID);
+        if (it != windowIds_.end()) {
+            ProcessEvent(*it->second, event);
+        }
+        return;
+    }
+    if (IsGlobalEvent(event)) {
+        for (auto& window : windows_) {
+            ProcessEvent(window.second, event);
         }
     }
-    return done;
 }
 
 void AppImpl::ProcessEvent(WindowInfo& wi, SDL_Event& event)
@@ -265,37 +854,387 @@ void AppImpl::ProcessEvent(WindowInfo& wi, SDL_Event& event)
     ImGui::SetCurrentContext(wi.imguiContext);
     ImGuiSDL3ProcessEvent(&event);
 
-    if (event.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED
-        && event.window.windowID == SDL_GetWindowID(wi.window)) {
+    // input, resizes and exposes of this window, or any display change
+    wi.canvas->RequestRedraw(Canvas::InputRedrawFrames);
+
+    if (event.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED) {
         App::CloseWindow(wi.canvas);
     }
+
+    if (event.type == SDL_EVENT_WINDOW_DISPLAY_CHANGED
+        || event.type == SDL_EVENT_DISPLAY_CURRENT_MODE_CHANGED) {
+        wi.pacer.SetDisplayRate(GetDisplayRefreshRate(wi.window));
+    }
+
+    // a distance field atlas scales cleanly, so only the scale changes
+    if (event.type == SDL_EVENT_WINDOW_DISPLAY_SCALE_CHANGED
+        && ImGuiGLGetFontAtlasMode() == ImGuiGLFontAtlasMode::Sdf) {
+        ImGui::GetIO().FontGlobalScale = GetFontScale(wi.window);
+    }
+}
+
+// Hands finished uploads to their canvases, their callbacks touch GL and
+// usually request a redraw, so this runs before the frames are picked.
+void AppImpl::PollUploads()
+{
+    if (!uploadService_->HasPending()) {
+        return;
+    }
+    AcquireGL();
+    uploadService_->Poll();
+    ReleaseGL();
+}
+
+// Swaps rebuilt programs in between frames, only takes the GL context when
+// a file changed or a build is in flight.
+void AppImpl::PollShaders()
+{
+    if (!shaderLibrary_->CheckFiles()) {
+        return;
+    }
+    AcquireGL();
+    const bool changed = shaderLibrary_->Poll();
+    ReleaseGL();
+    if (changed) {
+        for (auto& window : windows_) {
+            window.second.canvas->RequestRedraw();
+        }
+    }
 }
 
 void AppImpl::UpdateWindows()
 {
+    const auto now = SDL_GetTicksNS();
+    pendingFrames_.clear();
     for (auto& window : windows_) {
         auto& wi = window.second;
+        if (!continuous_ && !wi.canvas->NeedsRedraw()) {
+            wi.pacer.Suspend();
+            continue;
+        }
+        if (!continuous_ && !wi.pacer.IsDue(now)) {
+            continue;
+        }
+        wi.pacer.OnFrame(now);
+        pendingFrames_.push_back({&wi, SDL_GetTicksNS()});
+    }
+    if (pendingFrames_.empty()) {
+        return;
+    }
+
+    // Without a render thread the wait happens before any input is read, so
+    // a GPU bound frame samples the freshest input once it may start.
+    if (!renderThread_) {
+        RecordFrameWait()();
+    }
+    for (auto& frame : pendingFrames_) {
+        BeginFrame(frame);
+    }
+
+    // Canvases that do GL work in BuildUI, or can not record their
+    // rendering, need the context on the main thread for the whole frame.
+    auto sync = !renderThread_;
+    for (auto& frame : pendingFrames_) {
+        sync |= !frame.wi->canvas->IsBuildUIThreadSafe();
+    }
+    if (sync) {
+        AcquireGL();
+    }
+
+    BuildFrames();
 
-        // build ui
-        ImGui::SetCurrentContext(wi.imguiContext);
-        ImGuiGLNewFrame();
-        ImGuiSDL3NewFrame();
-        ImGui::NewFrame();
-        wi.canvas->BuildUI();
-        ImGui::Render();
+    if (!sync) {
+        for (auto& frame : pendingFrames_) {
+            ImGui::SetCurrentContext(frame.wi->imguiContext);
+            frame.render = frame.wi->canvas->RecordRender();
+            sync |= !frame.render;
+        }
+        if (sync) {
+            AcquireGL();
+        }
+    }
+
+    // build and render every due window before presenting any of them, a
+    // swap that blocks for a vblank then no longer delays the others
+    std::vector<RenderThread::Packet> commands;
+    if (renderThread_) {
+        commands.push_back(RecordFrameWait());
+    }
+    for (auto& frame : pendingFrames_) {
+        commands.push_back(RecordWindow(frame, sync));
+        frame.wi->canvas->OnFrameDrawn();
+    }
+
+    // only the window presented last waits for vblank, the rest swap
+    // immediately
+    WindowInfo* vsyncWindow = nullptr;
+    if (presentMode_ != App::PresentMode::Sequential) {
+        auto it = std::stable_partition(
+            pendingFrames_.begin(), pendingFrames_.end(),
+            [](const PendingFrame& frame) {
+                return frame.wi->pacer.GetSwapInterval() == 0;
+            });
+        if (it != pendingFrames_.end()) {
+            vsyncWindow = pendingFrames_.back().wi;
+        }
+    }
+    for (auto& frame : pendingFrames_) {
+        auto swapInterval = frame.wi->pacer.GetSwapInterval();
+        if (presentMode_ != App::PresentMode::Sequential
+            && frame.wi != vsyncWindow) {
+            swapInterval = 0;
+        }
+        commands.push_back(RecordPresent(frame, swapInterval));
+    }
+    commands.push_back([this]() { frameFences_->End(); });
+
+    if (sync) {
+        for (auto& command : commands) {
+            command();
+        }
+        ReleaseGL();
+    } else {
+        renderThread_->Submit([commands = std::move(commands)]() {
+            for (auto& command : commands) {
+                command();
+            }
+        });
+    }
+
+    for (auto& frame : pendingFrames_) {
+        if (benchmark_ && frame.wi->canvas == benchCanvas_
+            && benchmark_->OnFrame(*frame.wi->stats)) {
+            SDL_Event quit = {};
+            quit.type = SDL_EVENT_QUIT;
+            SDL_PushEvent(&quit);
+            benchCanvas_ = nullptr;
+        }
+    }
+}
+
+// The backends talk to SDL, so they stay on the main thread. The GL one
+// has created its objects in ImGuiGLInitContext and does no GL work here.
+void AppImpl::BeginFrame(PendingFrame& frame)
+{
+    const auto start = SDL_GetTicksNS();
+    ImGui::SetCurrentContext(frame.wi->imguiContext);
+    ImGuiGLNewFrame();
+    ImGuiSDL3NewFrame();
+    SDL_GetWindowSizeInPixels(frame.wi->window, &frame.width, &frame.height);
+    frame.newFrameNs = SDL_GetTicksNS() - start;
+}
+
+void AppImpl::BuildFrames()
+{
+    // thread safe canvases are built on the pool while the main thread
+    // builds the rest, then it helps the pool with whatever is left
+    parallelFrames_.clear();
+    for (auto& frame : pendingFrames_) {
+        if (workerPool_ && frame.wi->canvas->IsBuildUIThreadSafe()) {
+            parallelFrames_.push_back(&frame);
+        }
+    }
+    // ImGui::NewFrame() and Render() write the Locked flag of the shared
+    // font atlas, so they stay on the main thread around the batch
+    for (auto* frame : parallelFrames_) {
+        StartUI(*frame);
+    }
+    if (!parallelFrames_.empty()) {
+        workerPool_->Dispatch(parallelFrames_.size(), [this](size_t i) {
+            BuildUI(*parallelFrames_[i]);
+        });
+    }
+    for (auto& frame : pendingFrames_) {
+        if (!workerPool_ || !frame.wi->canvas->IsBuildUIThreadSafe()) {
+            StartUI(frame);
+            BuildUI(frame);
+            FinishUI(frame);
+        }
+    }
+    if (!parallelFrames_.empty()) {
+        workerPool_->Wait();
+    }
+    for (auto* frame : parallelFrames_) {
+        FinishUI(*frame);
+    }
+}
+
+void AppImpl::StartUI(PendingFrame& frame)
+{
+    ImGui::SetCurrentContext(frame.wi->imguiContext);
+    const auto start = SDL_GetTicksNS();
+    ImGui::NewFrame();
+    frame.wi->stats->Record(FrameStage::NewFrame,
+                            frame.newFrameNs + SDL_GetTicksNS() - start);
+}
+
+// Runs on any thread, everything in here may only touch ImGui and the
+// window's own canvas and stats.
+void AppImpl::BuildUI(PendingFrame& frame)
+{
+    auto& wi = *frame.wi;
+
+    ImGui::SetCurrentContext(wi.imguiContext);
+    const auto start = SDL_GetTicksNS();
+    wi.canvas->BuildUI();
+    frame.buildUINs = SDL_GetTicksNS() - start;
+    if (ImGui::IsAnyItemActive()) {
+        // dragging a widget or typing, keep going until it is released
+        wi.canvas->RequestRedraw(Canvas::InputRedrawFrames);
+    }
+    if (statsOverlay_) {
+        DrawFrameStatsOverlay(*wi.stats, wi.pacer,
+                              GL::GetResourceStats(wi.canvas));
+    }
+}
+
+void AppImpl::FinishUI(PendingFrame& frame)
+{
+    ImGui::SetCurrentContext(frame.wi->imguiContext);
+    const auto start = SDL_GetTicksNS();
+    ImGui::Render();
+    frame.wi->stats->Record(FrameStage::BuildUI,
+                            frame.buildUINs + SDL_GetTicksNS() - start);
+}
+
+// Everything the window's GL work needs is captured by value: with a render
+// thread the commands run while the main thread already builds the next
+// frame. WindowInfo itself stays alive, windows are only destroyed after
+// the render thread has been drained.
+RenderThread::Packet AppImpl::RecordWindow(PendingFrame& frame, bool sync)
+{
+    auto* wi = frame.wi;
+    auto  render = std::move(frame.render);
+    if (!render) {
+        render = [canvas = wi->canvas]() { canvas->Render(); };
+    }
+
+    // the next ImGui::NewFrame() of the context invalidates its draw data
+    ImGui::SetCurrentContext(wi->imguiContext);
+    std::shared_ptr<DrawDataCopy> drawData;
+    if (!sync) {
+        drawData = std::make_shared<DrawDataCopy>(ImGui::GetDrawData());
+    }
+
+    const auto offscreen
+        = headless_ || presentMode_ == App::PresentMode::Composite;
+    // the window API is main thread only, the title names the validation
+    // scope of the canvas
+    std::string title = SDL_GetWindowTitle(wi->window);
+    return [wi, render = std::move(render), drawData, offscreen,
+            validation = wi->canvas->GetGLValidation(),
+            title = std::move(title), width = frame.width,
+            height = frame.height, this]() {
+        auto& stats = *wi->stats;
 
         // render content and then ui
-        SDL_GL_MakeCurrent(wi.window, glContext_);
-        wi.canvas->Render();
-        ImGuiGLRenderDrawData(ImGui::GetDrawData());
+        ImGui::SetCurrentContext(wi->imguiContext);
+        SDL_GL_MakeCurrent(wi->window, glContext_);
+        if (offscreen) {
+            if (!wi->renderTarget) {
+                wi->renderTarget = std::make_shared<GL::RenderTarget>(
+                    std::max(width, 1), std::max(height, 1));
+            } else if (width > 0 && height > 0) {
+                wi->renderTarget->Resize(width, height);
+            }
+            wi->renderTarget->Bind();
+        } else {
+            // the previous window may have left its render target bound
+            wi->renderTarget.reset();
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+        if (wi->gpuTimer) {
+            wi->gpuTimer->BeginFrame([&stats](size_t scope, uint64_t ns) {
+                stats.Record(scope == GpuScopeRender
+                                 ? FrameStage::GpuRender
+                                 : FrameStage::GpuRenderUI,
+                             ns);
+            });
+        }
+        {
+            StageTimer        timer(stats, FrameStage::Render);
+            GL::GpuTimerScope gpuTimer(wi->gpuTimer.get(), GpuScopeRender);
+            GL::ValidationScope validationScope(validation, title.c_str());
+            render();
+        }
+        {
+            StageTimer        timer(stats, FrameStage::RenderUI);
+            GL::GpuTimerScope gpuTimer(wi->gpuTimer.get(), GpuScopeRenderUI);
+            ImGuiGLRenderDrawData(drawData ? drawData->Get()
+                                           : ImGui::GetDrawData());
+        }
+    };
+}
 
-        // present on screen
-        SDL_GL_SwapWindow(wi.window);
+RenderThread::Packet AppImpl::RecordPresent(PendingFrame& frame,
+                                            int           swapInterval)
+{
+    return [wi = frame.wi, swapInterval, start = frame.start,
+            width = frame.width, height = frame.height, headless = headless_,
+            readback = readback_, this]() {
+        auto& stats = *wi->stats;
+        {
+            StageTimer timer(stats, FrameStage::Swap);
+            if (headless) {
+                if (readback) {
+                    wi->renderTarget->Readback();
+                }
+                glFlush();
+            } else {
+                SDL_GL_MakeCurrent(wi->window, glContext_);
+                if (wi->swapInterval != swapInterval) {
+                    wi->swapInterval = swapInterval;
+                    SDL_GL_SetSwapInterval(swapInterval);
+                }
+                if (wi->renderTarget) {
+                    wi->renderTarget->BlitTo(0, width, height);
+                }
+                SDL_GL_SwapWindow(wi->window);
+            }
+        }
+        stats.Record(FrameStage::Total, SDL_GetTicksNS() - start);
+    };
+}
+
+// All windows share one context, so a frame covers every window rendered in
+// one iteration of the loop. Runs wherever the frame's GL commands run.
+RenderThread::Packet AppImpl::RecordFrameWait()
+{
+    std::vector<std::shared_ptr<FrameStats>> stats;
+    for (auto& frame : pendingFrames_) {
+        stats.push_back(frame.wi->stats);
+    }
+    return [this, stats = std::move(stats)]() {
+        const auto waited = frameFences_->Begin();
+        GL::GetDeletionQueue().Collect();
+        GL::GetStateCache().BeginFrame();
+        uniformArena_->BeginFrame(frameFences_->GetFrameIndex());
+        ImGuiGLBeginFrame(frameFences_->GetFrameIndex());
+        for (auto& s : stats) {
+            s->Record(FrameStage::FenceWait, waited);
+        }
+    };
+}
+
+void AppImpl::AcquireGL()
+{
+    if (renderThread_ && glAcquired_++ == 0) {
+        renderThread_->Acquire();
+        SDL_GL_MakeCurrent(fakeWindow_, glContext_);
+    }
+}
+
+void AppImpl::ReleaseGL()
+{
+    if (renderThread_ && --glAcquired_ == 0) {
+        SDL_GL_MakeCurrent(nullptr, nullptr);
+        renderThread_->Release();
     }
 }
 
 void AppImpl::Shutdown()
 {
+    SPDLOG_INFO("coalesced {} mouse motion events", coalescedEvents_);
     CloseAllWindows();
     ShutdownUI();
     ShutdownRenderer();
@@ -311,11 +1250,24 @@ void AppImpl::ShutdownPlatform()
 
 void AppImpl::ShutdownRenderer()
 {
+    uploadService_.reset();
+    shaderLibrary_.reset();
+    GL::SetUniformArena(nullptr);
+    uniformArena_.reset();
+    GL::GetDeletionQueue().Flush();
+    GL::GetDeletionQueue().SetFrameFences(nullptr);
+    frameFences_.reset();
+    GL::SetProgramCache(nullptr);
+    programCache_.reset();
     SDL_GL_MakeCurrent(nullptr, nullptr);
     SDL_GL_DestroyContext(glContext_);
 }
 
-void AppImpl::ShutdownUI() { ImGuiGLShutdown(); }
+void AppImpl::ShutdownUI()
+{
+    workerPool_.reset();
+    ImGuiGLShutdown();
+}
 
 bool AppImpl::OpenWindow(Canvas* canvas)
 {
@@ -331,17 +1283,26 @@ bool AppImpl::OpenWindow(Canvas* canvas)
     }
 
     WindowInfo wi;
-    wi.window = CreatePlatformWindow("");
+    wi.window = CreatePlatformWindow("", windowWidth_, windowHeight_);
     if (!wi.window) {
         return false;
     }
 
+    AcquireGL();
     wi.imguiContext = CreateImGuiContext(wi.window, glContext_, fontAtlas_, "");
+    ReleaseGL();
     if (!wi.imguiContext) {
         return false;
     }
 
     wi.canvas = canvas;
+    wi.stats = std::make_shared<FrameStats>();
+    if (GL::GpuTimer::IsSupported()) {
+        wi.gpuTimer = std::make_shared<GL::GpuTimer>(GpuScopeCount);
+    }
+    wi.pacer.SetMode(defaultPacing_);
+    wi.pacer.SetTargetRate(defaultRate_);
+    wi.pacer.SetDisplayRate(GetDisplayRefreshRate(wi.window));
     windowsCreateQueue_.push_back(wi);
     return true;
 }
@@ -351,6 +1312,25 @@ bool AppImpl::IsOpened(Canvas* canvas) const
     return windows_.find(canvas) != windows_.end();
 }
 
+WindowInfo* AppImpl::FindWindow(Canvas* canvas)
+{
+    return const_cast<WindowInfo*>(std::as_const(*this).FindWindow(canvas));
+}
+
+const WindowInfo* AppImpl::FindWindow(Canvas* canvas) const
+{
+    auto it = windows_.find(canvas);
+    if (it != windows_.end()) {
+        return &it->second;
+    }
+    for (const auto& wi : windowsCreateQueue_) {
+        if (wi.canvas == canvas) {
+            return &wi;
+        }
+    }
+    return nullptr;
+}
+
 bool AppImpl::CloseWindow(Canvas* canvas)
 {
     if (!canvas) {
@@ -362,38 +1342,77 @@ bool AppImpl::CloseWindow(Canvas* canvas)
         return false;
     }
 
-    windowsDestroyQueue_.push_back(it->second);
+    windowsDestroyQueue_.push_back(canvas);
     return true;
 }
 
 void AppImpl::CloseAllWindows()
 {
     for (auto& window : windows_) {
-        auto& wi = window.second;
-        DestroyImGuiContext(wi.imguiContext);
-        DestroyPlatformWindow(wi.window);
-        delete wi.canvas;
+        DestroyWindow(window.second);
     }
+    windows_.clear();
+    windowIds_.clear();
+    pendingMotion_.reset();
 }
 
 void AppImpl::ProcessWindowsCreateQueue()
 {
     for (auto& wi: windowsCreateQueue_) {
-        windows_[wi.canvas] = wi;
+        auto& window = windows_[wi.canvas];
+        window = wi;
+        windowIds_[SDL_GetWindowID(window.window)] = &window;
     }
     windowsCreateQueue_.clear();
 }
 
 void AppImpl::ProcessWindowsDestroyQueue()
 {
-    for (auto& wi: windowsDestroyQueue_) {
-        auto it = windows_.find(wi.canvas); // 100% there
+    if (windowsDestroyQueue_.empty()) {
+        return;
+    }
+
+    // queued frames may still use the windows and canvases
+    AcquireGL();
+    for (auto* canvas: windowsDestroyQueue_) {
+        auto it = windows_.find(canvas);
+        if (it == windows_.end()) {
+            continue; // closed twice in one frame
+        }
+        windowIds_.erase(SDL_GetWindowID(it->second.window));
+        DestroyWindow(it->second);
         windows_.erase(it);
-        DestroyImGuiContext(wi.imguiContext);
-        DestroyPlatformWindow(wi.window);
-        delete wi.canvas; // FIXME
+
+        // other canvases may show which windows are open
+        for (auto& window : windows_) {
+            window.second.canvas->RequestRedraw();
+        }
     }
     windowsDestroyQueue_.clear();
+    ReleaseGL();
+}
+
+void AppImpl::DestroyWindow(WindowInfo& wi)
+{
+    LogPacingStats(wi);
+
+    // canvas and window GL objects need a current context, which would be
+    // gone if the window being destroyed was the current one
+    SDL_GL_MakeCurrent(fakeWindow_, glContext_);
+    const void* owner = wi.canvas;
+    delete wi.canvas;
+    // every object of a destroyed canvas should be waiting for deletion
+    const auto& resources = GL::GetResourceStats(owner);
+    const auto  objects = resources.GetObjects();
+    const auto  pending = resources.pending.load();
+    if (objects != pending) {
+        SPDLOG_ERROR("canvas {} left {} gl objects alive, {} are deleted",
+                     owner, objects, pending);
+    }
+    wi.gpuTimer.reset();
+    wi.renderTarget.reset();
+    DestroyImGuiContext(wi.imguiContext);
+    DestroyPlatformWindow(wi.window);
 }
 
 App::App(int argc, char** argv)
@@ -414,6 +1433,100 @@ int App::Exec()
     return res;
 }
 
+void App::SetContinuous(bool continuous)
+{
+    assert(g_app);
+    g_app->SetContinuous(continuous);
+}
+
+bool App::IsContinuous()
+{
+    assert(g_app);
+    return g_app->IsContinuous();
+}
+
+bool App::SetFramePacing(Canvas* canvas, FramePacer::Mode mode, double rate)
+{
+    assert(g_app);
+    auto* wi = g_app->FindWindow(canvas);
+    if (!wi) {
+        return false;
+    }
+    wi->pacer.SetMode(mode);
+    if (mode == FramePacer::Mode::Fixed) {
+        wi->pacer.SetTargetRate(rate);
+    }
+    return true;
+}
+
+const FramePacer* App::GetFramePacer(Canvas* canvas)
+{
+    assert(g_app);
+    const auto* wi = g_app->FindWindow(canvas);
+    return wi ? &wi->pacer : nullptr;
+}
+
+void App::SetStatsOverlay(bool shown)
+{
+    assert(g_app);
+    g_app->SetStatsOverlay(shown);
+}
+
+bool App::IsStatsOverlayShown()
+{
+    assert(g_app);
+    return g_app->IsStatsOverlayShown();
+}
+
+bool App::IsHeadless()
+{
+    assert(g_app);
+    return g_app->IsHeadless();
+}
+
+void App::SetPresentMode(PresentMode mode)
+{
+    assert(g_app);
+    g_app->SetPresentMode(mode);
+}
+
+App::PresentMode App::GetPresentMode()
+{
+    assert(g_app);
+    return g_app->GetPresentMode();
+}
+
+bool App::IsBenchmark()
+{
+    assert(g_app);
+    return g_app->IsBenchmark();
+}
+
+const FrameStats* App::GetFrameStats(Canvas* canvas)
+{
+    assert(g_app);
+    const auto* wi = g_app->FindWindow(canvas);
+    return wi ? wi->stats.get() : nullptr;
+}
+
+const GL::FrameFences* App::GetFrameFences()
+{
+    assert(g_app);
+    return g_app->GetFrameFences();
+}
+
+GL::UploadService* App::GetUploadService()
+{
+    assert(g_app);
+    return g_app->GetUploadService();
+}
+
+GL::ShaderLibrary* App::GetShaderLibrary()
+{
+    assert(g_app);
+    return g_app->GetShaderLibrary();
+}
+
 bool App::OpenWindow(Canvas* canvas)
 {
     assert(g_app);
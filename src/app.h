@@ -1,6 +1,14 @@
 #pragma once
 
+#include "frame_pacer.h"
+
 class Canvas;
+class FrameStats;
+namespace GL {
+class FrameFences;
+class ShaderLibrary;
+class UploadService;
+}
 
 class App
 {
@@ -14,6 +22,54 @@ public:
 
     int Exec();
 
+    // How the windows that rendered a frame are presented (--present).
+    enum class PresentMode
+    {
+        Sequential, // every window swaps with its own pacer's interval
+        VSyncLast,  // only the window swapped last waits for vblank
+        Composite,  // render all into offscreen targets, then blit and swap
+    };
+
+    // Continuous mode renders as fast as possible without waiting for
+    // events or frame deadlines (benchmarking). Also enabled by --continuous.
+    static void SetContinuous(bool continuous);
+    static bool IsContinuous();
+
+    // Per-window frame pacing, rate is only used by FramePacer::Mode::Fixed.
+    // The default for new windows is set with --pacing.
+    static bool SetFramePacing(Canvas* canvas, FramePacer::Mode mode,
+                               double rate = FramePacer::DefaultRate);
+    static const FramePacer* GetFramePacer(Canvas* canvas);
+
+    // Headless mode (--headless) uses SDL's offscreen video driver and
+    // renders every window into an FBO of --size WxH instead of presenting.
+    static bool IsHeadless();
+
+    static void        SetPresentMode(PresentMode mode);
+    static PresentMode GetPresentMode();
+
+    // Benchmark mode (--bench <canvas> [--warmup N] [--frames N]
+    // [--vsync on|off] [--report file]) opens only the given canvas and
+    // quits after writing a JSON report.
+    static bool IsBenchmark();
+
+    // Per-stage timing overlay in every window, toggled with F3 or --stats.
+    static void SetStatsOverlay(bool shown);
+    static bool IsStatsOverlayShown();
+    static const FrameStats* GetFrameStats(Canvas* canvas);
+
+    // Frames the CPU may queue ahead of the GPU (--frames-in-flight N,
+    // default 2). Its frame index is valid while the frame's GL commands run.
+    static const GL::FrameFences* GetFrameFences();
+
+    // Background texture/buffer uploads on a context shared with the
+    // windows, see GL::UploadService.
+    static GL::UploadService* GetUploadService();
+
+    // Shader files of assets/shaders, rebuilt when they change if
+    // --shader-reload on is given, see GL::ShaderLibrary.
+    static GL::ShaderLibrary* GetShaderLibrary();
+
     static bool OpenWindow(Canvas* canvas);
     static bool IsOpened(Canvas* canvas);
     static bool CloseWindow(Canvas* canvas);
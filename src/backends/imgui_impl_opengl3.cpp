@@ -17,15 +17,22 @@
 //----------------------------------------
 
 #include "gl/framework.h"
+#include "gl/stream_buffer.h"
 #include <imgui.h>
 #ifndef IMGUI_DISABLE
 #include "imgui_impl_opengl3.h"
 #include <glad/glad.h>
 #include <stdint.h> // intptr_t
+#include <math.h>   // sqrtf
+#include <string.h> // memcpy
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
 
-#ifdef IMGUI_IMPL_OPENGL_DEBUG
 #include <spdlog/spdlog.h>
-#endif
 
 
 // Clang/GCC warnings with -Weverything
@@ -61,21 +68,56 @@
 // OpenGL Data
 struct ImGuiGLData
 {
-    GLint        attribLocationTex; // Uniforms location
-    GLint        attribLocationProjMtx;
-    GLuint       attribLocationVtxPos; // Vertex attributes location
-    GLuint       attribLocationVtxUv;
-    GLuint       attribLocationVtxColor;
-    unsigned int vboHandle, elementsHandle;
-    GLsizeiptr   vertexBufferSize;
-    GLsizeiptr   indexBufferSize;
-
-    ImGuiGLData() { memset((void*)this, 0, sizeof(*this)); }
+    GLint           attribLocationTex = 0; // Uniforms location
+    GLint           attribLocationProjMtx = 0;
+    GLuint          attribLocationVtxPos = 0; // Vertex attributes location
+    GLuint          attribLocationVtxUv = 0;
+    GLuint          attribLocationVtxColor = 0;
+    // formats set up once, buffers bound with DSA; owned by the ImGui
+    // context, i.e. counted for its window
+    GL::VertexArray vertexArray;
+    // grow count + 1 of the stream buffer attached as the element buffer of
+    // vertexArray, 0 - none; names are no use, a new buffer may reuse one
+    uint64_t        streamGeneration = 0;
+};
+
+// Per draw data of the batched path, std430 layout of Draw in the shader.
+struct ImGuiGLDraw
+{
+    ImVec4 clipRect; // in ImGui coordinates, like the vertices
+    GLuint textureSlot;
+    GLuint pad[3];
 };
+static_assert(sizeof(ImGuiGLDraw) == 32, "must match the std430 layout");
 
 namespace {
 GLuint g_shaderHandle;
-GLuint g_fontTexture;
+// shared by every context, unowned like the stream buffer
+GL::Texture g_fontTexture;
+// vertices and indices of every context, one region per frame in flight
+std::unique_ptr<GL::StreamBuffer> g_streamBuffer;
+constexpr GLsizeiptr              StreamRegionSize = 1 << 20;
+
+// The batched path clips with clip distances instead of the scissor and
+// samples from a table of textures, so runs of commands become one
+// glMultiDrawElementsBaseVertex.
+constexpr GLuint BatchTextureSlots = 8;
+bool             g_batching = true;
+GLuint           g_batchShaderHandle;
+GLint            g_batchProjMtxLoc;
+GLint            g_batchDrawBaseLoc;
+GLsizeiptr       g_ssboAlignment = 256;
+
+// single channel (default) or distance field atlas, see ImGuiGLFontAtlasMode
+ImGuiGLFontAtlasMode g_fontAtlasMode = ImGuiGLFontAtlasMode::Alpha8;
+GLint                g_sdfLoc = -1;
+constexpr GLuint     SdfTextureFlag = 0x100; // or'ed to textureSlot
+
+// per frame, published by ImGuiGLBeginFrame
+uint64_t              g_frameCommands = 0;
+uint64_t              g_frameDrawCalls = 0;
+std::atomic<uint64_t> g_lastCommands = 0;
+std::atomic<uint64_t> g_lastDrawCalls = 0;
 } // namespace
 
 // Backend data stored in io.BackendRendererUserData to allow support for
@@ -91,7 +133,57 @@ static ImGuiGLData* ImGuiGLGetBackendData()
 
 // Functions
 
-bool ImGuiGLInit() { return ImGuiGLCreateShader(); }
+bool ImGuiGLInit(uint32_t framesInFlight)
+{
+    g_streamBuffer
+        = std::make_unique<GL::StreamBuffer>(StreamRegionSize, framesInFlight);
+    GLint alignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment > 0) {
+        g_ssboAlignment = alignment;
+    }
+    return ImGuiGLCreateShader();
+}
+
+void ImGuiGLBeginFrame(uint32_t frameIndex)
+{
+    g_streamBuffer->BeginFrame(frameIndex);
+    g_lastCommands.store(g_frameCommands, std::memory_order_relaxed);
+    g_lastDrawCalls.store(g_frameDrawCalls, std::memory_order_relaxed);
+    g_frameCommands = 0;
+    g_frameDrawCalls = 0;
+}
+
+void ImGuiGLSetBatching(bool batching) { g_batching = batching; }
+
+void ImGuiGLSetFontAtlasMode(ImGuiGLFontAtlasMode mode)
+{
+    g_fontAtlasMode = mode;
+}
+
+ImGuiGLFontAtlasMode ImGuiGLGetFontAtlasMode() { return g_fontAtlasMode; }
+
+const char* ToString(ImGuiGLFontAtlasMode mode)
+{
+    switch (mode) {
+    case ImGuiGLFontAtlasMode::RGBA32:
+        return "rgba";
+    case ImGuiGLFontAtlasMode::Alpha8:
+        return "r8";
+    case ImGuiGLFontAtlasMode::Sdf:
+        return "sdf";
+    default:
+        return "unknown";
+    }
+}
+
+bool ImGuiGLIsBatching() { return g_batching && g_batchShaderHandle; }
+
+ImGuiGLFrameStats ImGuiGLGetLastFrameStats()
+{
+    return {g_lastCommands.load(std::memory_order_relaxed),
+            g_lastDrawCalls.load(std::memory_order_relaxed)};
+}
 
 bool ImGuiGLInitContext()
 {
@@ -123,6 +215,13 @@ bool ImGuiGLInitContext()
                                                    // ImDrawCmd::VtxOffset
                                                    // field, allowing for large
                                                    // meshes.
+
+    // Create the GL objects right away instead of in the first NewFrame, so
+    // that NewFrame never touches GL and can run without the context.
+    if (!g_fontTexture) {
+        ImGuiGLCreateFontsTexture();
+    }
+    ImGuiGLCreateDeviceObjects();
     return true;
 }
 
@@ -130,6 +229,7 @@ void ImGuiGLShutdown()
 {
     ImGuiGLDestroyShader();
     ImGuiGLDestroyFontsTexture();
+    g_streamBuffer.reset();
 }
 
 void ImGuiGLShutdownContext()
@@ -157,44 +257,44 @@ void ImGuiGLNewFrame()
     if (!g_fontTexture) {
         ImGuiGLCreateFontsTexture();
     }
-    if (!bd->vboHandle) {
+    if (!bd->vertexArray) {
         ImGuiGLCreateDeviceObjects();
     }
 
     ImGuiIO& io = ImGui::GetIO();
-    io.Fonts->SetTexID((ImTextureID)(intptr_t)g_fontTexture);
+    io.Fonts->SetTexID((ImTextureID)(intptr_t)g_fontTexture.Get());
 }
 
 static void ImGuiGLSetupRenderState(ImDrawData* drawData, int fbWidth,
-                                    int fbHeight, GLuint vertexArrayObject)
+                                    int fbHeight, bool batched)
 {
     ImGuiGLData* bd = ImGuiGLGetBackendData();
 
     // Setup render state: alpha-blending enabled, no face culling, no depth
-    // testing, scissor enabled, polygon fill
-    glEnable(GL_BLEND);
-    glBlendEquation(GL_FUNC_ADD);
-    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
-                        GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glEnable(GL_SCISSOR_TEST);
-    glDisable(GL_PRIMITIVE_RESTART);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    // testing, scissor or clip distances enabled, polygon fill
+    auto& state = GL::GetStateCache();
+    state.SetEnabled(GL_BLEND, true);
+    state.BlendEquation(GL_FUNC_ADD, GL_FUNC_ADD);
+    state.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                    GL_ONE_MINUS_SRC_ALPHA);
+    state.SetEnabled(GL_CULL_FACE, false);
+    state.SetEnabled(GL_DEPTH_TEST, false);
+    state.SetEnabled(GL_STENCIL_TEST, false);
+    state.SetEnabled(GL_SCISSOR_TEST, !batched);
+    for (GLenum i = 0; i < 4; ++i) {
+        state.SetEnabled(GL_CLIP_DISTANCE0 + i, batched);
+    }
+    state.SetEnabled(GL_PRIMITIVE_RESTART, false);
+    state.PolygonMode(GL_FILL);
 
     // Support for GL 4.5 rarely used glClipControl(GL_UPPER_LEFT)
-    bool   clipOriginLowerLeft = true;
-    GLenum currentClipOrigin = 0;
-    glGetIntegerv(GL_CLIP_ORIGIN, (GLint*)&currentClipOrigin);
-    if (currentClipOrigin == GL_UPPER_LEFT)
-        clipOriginLowerLeft = false;
+    const bool clipOriginLowerLeft = state.GetCurrent().clipOrigin != GL_UPPER_LEFT;
 
     // Setup viewport, orthographic projection matrix
     // Our visible imgui space lies from draw_data->DisplayPos (top left) to
     // draw_data->DisplayPos+data_data->DisplaySize (bottom right). DisplayPos
     // is (0,0) for single viewport apps.
-    GL_CALL(glViewport(0, 0, (GLsizei)fbWidth, (GLsizei)fbHeight));
+    state.Viewport(0, 0, (GLsizei)fbWidth, (GLsizei)fbHeight);
     float l = drawData->DisplayPos.x;
     float r = drawData->DisplayPos.x + drawData->DisplaySize.x;
     float t = drawData->DisplayPos.y;
@@ -210,35 +310,105 @@ static void ImGuiGLSetupRenderState(ImDrawData* drawData, int fbWidth,
         { 0.0f, 0.0f, -1.0f, 0.0f },
         { (r + l) / (l - r), (t + b) / (b - t), 0.0f, 1.0f },
     };
-    glUseProgram(g_shaderHandle);
-    glUniform1i(bd->attribLocationTex, 0);
-    glUniformMatrix4fv(bd->attribLocationProjMtx, 1, GL_FALSE,
-                       &orthoProjection[0][0]);
-    glBindSampler(0, 0); // We use combined texture/sampler state. Applications
-                         // using GL 3.3 and GL ES 3.0 may set that otherwise.
-    glBindVertexArray(vertexArrayObject);
-
-    // Bind vertex/index buffers and setup attributes for ImDrawVert
-    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, bd->vboHandle));
-    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bd->elementsHandle));
-    GL_CALL(glEnableVertexAttribArray(bd->attribLocationVtxPos));
-    GL_CALL(glEnableVertexAttribArray(bd->attribLocationVtxUv));
-    GL_CALL(glEnableVertexAttribArray(bd->attribLocationVtxColor));
-    GL_CALL(glVertexAttribPointer(bd->attribLocationVtxPos, 2, GL_FLOAT,
-                                  GL_FALSE, sizeof(ImDrawVert),
-                                  (GLvoid*)offsetof(ImDrawVert, pos)));
-    GL_CALL(glVertexAttribPointer(bd->attribLocationVtxUv, 2, GL_FLOAT,
-                                  GL_FALSE, sizeof(ImDrawVert),
-                                  (GLvoid*)offsetof(ImDrawVert, uv)));
-    GL_CALL(glVertexAttribPointer(bd->attribLocationVtxColor, 4,
-                                  GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert),
-                                  (GLvoid*)offsetof(ImDrawVert, col)));
+    if (batched) {
+        state.UseProgram(g_batchShaderHandle);
+        glUniformMatrix4fv(g_batchProjMtxLoc, 1, GL_FALSE,
+                           &orthoProjection[0][0]);
+    } else {
+        state.UseProgram(g_shaderHandle);
+        glUniform1i(bd->attribLocationTex, 0);
+        glUniform1i(g_sdfLoc, GL_FALSE);
+        glUniformMatrix4fv(bd->attribLocationProjMtx, 1, GL_FALSE,
+                           &orthoProjection[0][0]);
+    }
+    // We use combined texture/sampler state.
+    for (GLuint unit = 0; unit < (batched ? BatchTextureSlots : 1); ++unit) {
+        state.BindSampler(unit, 0);
+    }
+    state.BindVertexArray(bd->vertexArray.Get());
 }
 
+// Collects runs of draw commands that only differ in clip rect and texture
+// (up to BatchTextureSlots distinct ones) and submits each run as one
+// multi-draw. gl_DrawID indexes the per draw data from DrawBase on.
+class ImGuiGLBatch
+{
+public:
+    ImGuiGLBatch(ImGuiGLDraw* draws, GLintptr indexOffset)
+        : draws_(draws)
+        , indexOffset_(indexOffset)
+    {
+    }
+
+    void Add(const ImDrawCmd& cmd, GLintptr listIndexOffset, GLint listVertexOffset)
+    {
+        const auto texture = (GLuint)(intptr_t)cmd.GetTexID();
+        GLuint     slot = 0;
+        while (slot < textureCount_ && textures_[slot] != texture) {
+            ++slot;
+        }
+        if (slot == BatchTextureSlots) {
+            Flush();
+            slot = 0;
+        }
+        if (slot == textureCount_) {
+            textures_[textureCount_++] = texture;
+        }
+
+        auto& draw = draws_[drawCount_++];
+        draw.clipRect = cmd.ClipRect;
+        draw.textureSlot = slot;
+        if (texture == g_fontTexture.Get()
+            && g_fontAtlasMode == ImGuiGLFontAtlasMode::Sdf) {
+            draw.textureSlot |= SdfTextureFlag;
+        }
+        counts_.push_back((GLsizei)cmd.ElemCount);
+        offsets_.push_back((const void*)(indexOffset_ + listIndexOffset
+                                         + cmd.IdxOffset * sizeof(ImDrawIdx)));
+        baseVertices_.push_back(listVertexOffset + (GLint)cmd.VtxOffset);
+    }
+
+    void Flush()
+    {
+        if (counts_.empty()) {
+            return;
+        }
+        auto& state = GL::GetStateCache();
+        for (GLuint slot = 0; slot < textureCount_; ++slot) {
+            state.BindTexture(slot, textures_[slot]);
+        }
+        glUniform1ui(g_batchDrawBaseLoc, drawBase_);
+        GL_CALL(glMultiDrawElementsBaseVertex(
+            GL_TRIANGLES, counts_.data(),
+            sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+            offsets_.data(), (GLsizei)counts_.size(), baseVertices_.data()));
+        ++g_frameDrawCalls;
+
+        drawBase_ = drawCount_;
+        textureCount_ = 0;
+        counts_.clear();
+        offsets_.clear();
+        baseVertices_.clear();
+    }
+
+private:
+    ImGuiGLDraw* draws_;
+    GLintptr     indexOffset_;
+    GLuint       drawCount_ = 0;
+    GLuint       drawBase_ = 0;
+
+    std::array<GLuint, BatchTextureSlots> textures_ = {};
+    GLuint                                textureCount_ = 0;
+
+    // reused by every batch of every window, the GL thread is the only user
+    static inline std::vector<GLsizei>     counts_;
+    static inline std::vector<const void*> offsets_;
+    static inline std::vector<GLint>       baseVertices_;
+};
+
 // OpenGL3 Render function.
-// Note that this implementation is little overcomplicated because we are
-// saving/setting up/restoring every OpenGL state explicitly. This is in order
-// to be able to run within an OpenGL engine that doesn't do so.
+// The state is saved, set up and restored through GL::StateCache, so nothing
+// is queried from the driver and unchanged state is never set twice.
 void ImGuiGLRenderDrawData(ImDrawData* drawData)
 {
     // Avoid rendering when minimized, scale coordinates for retina displays
@@ -250,54 +420,14 @@ void ImGuiGLRenderDrawData(ImDrawData* drawData)
         return;
 
     ImGuiGLData* bd = ImGuiGLGetBackendData();
+    const bool   batched = ImGuiGLIsBatching();
 
     // Backup GL state
-    GLenum lastActiveTexture;
-    glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&lastActiveTexture);
-    glActiveTexture(GL_TEXTURE0);
-    GLuint lastProgram;
-    glGetIntegerv(GL_CURRENT_PROGRAM, (GLint*)&lastProgram);
-    GLuint lastTexture;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, (GLint*)&lastTexture);
-    GLuint lastSampler;
-    glGetIntegerv(GL_SAMPLER_BINDING, (GLint*)&lastSampler);
-    GLuint lastArrayBuffer;
-    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, (GLint*)&lastArrayBuffer);
-    GLuint lastVertexArrayObject;
-    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, (GLint*)&lastVertexArrayObject);
-    GLint lastPolygonMode[2];
-    glGetIntegerv(GL_POLYGON_MODE, lastPolygonMode);
-    GLint lastViewport[4];
-    glGetIntegerv(GL_VIEWPORT, lastViewport);
-    GLint lastScissorBox[4];
-    glGetIntegerv(GL_SCISSOR_BOX, lastScissorBox);
-    GLenum lastBlendSrcRgb;
-    glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&lastBlendSrcRgb);
-    GLenum lastBlendDstRgb;
-    glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&lastBlendDstRgb);
-    GLenum lastBlendSrcAlpha;
-    glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&lastBlendSrcAlpha);
-    GLenum lastBlendDstAlpha;
-    glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&lastBlendDstAlpha);
-    GLenum lastBlendEquationRgb;
-    glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&lastBlendEquationRgb);
-    GLenum lastBlendEquationAlpha;
-    glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&lastBlendEquationAlpha);
-    GLboolean lastEnableBlend = glIsEnabled(GL_BLEND);
-    GLboolean lastEnableCullFace = glIsEnabled(GL_CULL_FACE);
-    GLboolean lastEnableDepthTest = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean lastEnableStencilTest = glIsEnabled(GL_STENCIL_TEST);
-    GLboolean lastEnableScissorTest = glIsEnabled(GL_SCISSOR_TEST);
-    GLboolean lastEnablePrimitiveRestart = glIsEnabled(GL_PRIMITIVE_RESTART);
+    auto&      state = GL::GetStateCache();
+    const auto lastState = state.Save();
 
     // Setup desired GL state
-    // Recreate the VAO every time (this is to easily allow multiple GL contexts
-    // to be rendered to. VAO are not shared among GL contexts) The renderer
-    // would actually work without any VAO bound, but then our VertexAttrib
-    // calls would overwrite the default one currently bound.
-    GLuint vertexArrayObject = 0;
-    GL_CALL(glGenVertexArrays(1, &vertexArrayObject));
-    ImGuiGLSetupRenderState(drawData, fbWidth, fbHeight, vertexArrayObject);
+    ImGuiGLSetupRenderState(drawData, fbWidth, fbHeight, batched);
 
     // Will project scissor/clipping rectangles into framebuffer space
     ImVec2 clipOff = drawData->DisplayPos; // (0,0) unless using multi-viewports
@@ -305,169 +435,267 @@ void ImGuiGLRenderDrawData(ImDrawData* drawData)
         = drawData->FramebufferScale; // (1,1) unless using retina display which
                                       // are often (2,2)
 
-    // Render command lists
+    // Copy the vertices and indices of all command lists into the stream
+    // buffer in one go, after room for the per draw data of the batched path.
+    // The memory is coherent, so there is nothing to flush and no implicit
+    // sync. A single allocation never ends up split over two buffers.
+    GLsizeiptr drawsSize = 0;
+    if (batched) {
+        for (int n = 0; n < drawData->CmdListsCount; n++) {
+            drawsSize += drawData->CmdLists[n]->CmdBuffer.Size
+                * (GLsizeiptr)sizeof(ImGuiGLDraw);
+        }
+    }
+    const GLsizeiptr vtxSize
+        = (GLsizeiptr)drawData->TotalVtxCount * (int)sizeof(ImDrawVert);
+    const GLsizeiptr idxSize
+        = (GLsizeiptr)drawData->TotalIdxCount * (int)sizeof(ImDrawIdx);
+    const auto upload = g_streamBuffer->Allocate(drawsSize + vtxSize + idxSize,
+                                                 g_ssboAlignment);
+    auto*      vtxDst = (uint8_t*)upload.data + drawsSize;
+    auto*      idxDst = vtxDst + vtxSize;
     for (int n = 0; n < drawData->CmdListsCount; n++) {
         const ImDrawList* drawList = drawData->CmdLists[n];
-        const GLsizeiptr  vtxBufferSize
-            = (GLsizeiptr)drawList->VtxBuffer.Size * (int)sizeof(ImDrawVert);
-        const GLsizeiptr idxBufferSize
-            = (GLsizeiptr)drawList->IdxBuffer.Size * (int)sizeof(ImDrawIdx);
-        if (bd->vertexBufferSize < vtxBufferSize) {
-            bd->vertexBufferSize = vtxBufferSize;
-            GL_CALL(glBufferData(GL_ARRAY_BUFFER, bd->vertexBufferSize, nullptr,
-                                 GL_STREAM_DRAW));
-        }
-        if (bd->indexBufferSize < idxBufferSize) {
-            bd->indexBufferSize = idxBufferSize;
-            GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, bd->indexBufferSize,
-                                 nullptr, GL_STREAM_DRAW));
-        }
-        GL_CALL(glBufferSubData(GL_ARRAY_BUFFER, 0, vtxBufferSize,
-                                (const GLvoid*)drawList->VtxBuffer.Data));
-        GL_CALL(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, idxBufferSize,
-                                (const GLvoid*)drawList->IdxBuffer.Data));
+        const size_t vtxListSize = drawList->VtxBuffer.Size * sizeof(ImDrawVert);
+        const size_t idxListSize = drawList->IdxBuffer.Size * sizeof(ImDrawIdx);
+        memcpy(vtxDst, drawList->VtxBuffer.Data, vtxListSize);
+        memcpy(idxDst, drawList->IdxBuffer.Data, idxListSize);
+        vtxDst += vtxListSize;
+        idxDst += idxListSize;
+    }
+
+    const GLuint buffer = g_streamBuffer->GetBuffer();
+    const auto   generation = g_streamBuffer->GetGrowCount() + 1;
+    if (bd->streamGeneration != generation) {
+        bd->streamGeneration = generation;
+        GL_CALL(glVertexArrayElementBuffer(bd->vertexArray.Get(), buffer));
+    }
+    GL_CALL(glVertexArrayVertexBuffer(bd->vertexArray.Get(), 0, buffer,
+                                      upload.offset + drawsSize,
+                                      sizeof(ImDrawVert)));
+    if (drawsSize > 0) {
+        state.BindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, buffer,
+                              upload.offset, drawsSize);
+    }
 
+    // Render command lists
+    const GLintptr idxStart = upload.offset + drawsSize + vtxSize; // in bytes
+    ImGuiGLBatch   batch((ImGuiGLDraw*)upload.data, idxStart);
+    GLintptr       globalIdxOffset = 0; // in bytes
+    GLint          globalVtxOffset = 0;
+    bool           sdf = false; // the Sdf uniform of the unbatched path
+    for (int n = 0; n < drawData->CmdListsCount; n++) {
+        const ImDrawList* drawList = drawData->CmdLists[n];
         for (int cmdI = 0; cmdI < drawList->CmdBuffer.Size; cmdI++) {
             const ImDrawCmd* pcmd = &drawList->CmdBuffer[cmdI];
             if (pcmd->UserCallback != nullptr) {
+                batch.Flush();
                 // User callback, registered via ImDrawList::AddCallback()
                 // (ImDrawCallback_ResetRenderState is a special callback value
                 // used by the user to request the renderer to reset render
                 // state.)
-                if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
+                if (pcmd->UserCallback == ImDrawCallback_ResetRenderState) {
                     ImGuiGLSetupRenderState(drawData, fbWidth, fbHeight,
-                                            vertexArrayObject);
-                else
+                                            batched);
+                    sdf = false;
+                } else
                     pcmd->UserCallback(drawList, pcmd);
-            } else {
-                // Project scissor/clipping rectangles into framebuffer space
-                ImVec2 clipMin((pcmd->ClipRect.x - clipOff.x) * clipScale.x,
-                               (pcmd->ClipRect.y - clipOff.y) * clipScale.y);
-                ImVec2 clipMax((pcmd->ClipRect.z - clipOff.x) * clipScale.x,
-                               (pcmd->ClipRect.w - clipOff.y) * clipScale.y);
-                if (clipMax.x <= clipMin.x || clipMax.y <= clipMin.y)
-                    continue;
+                continue;
+            }
 
-                // Apply scissor/clipping rectangle (Y is inverted in OpenGL)
-                GL_CALL(glScissor((int)clipMin.x,
-                                  (int)((float)fbHeight - clipMax.y),
-                                  (int)(clipMax.x - clipMin.x),
-                                  (int)(clipMax.y - clipMin.y)));
-
-                // Bind texture, Draw
-                GL_CALL(glBindTexture(GL_TEXTURE_2D,
-                                      (GLuint)(intptr_t)pcmd->GetTexID()));
-                GL_CALL(glDrawElementsBaseVertex(
-                    GL_TRIANGLES, (GLsizei)pcmd->ElemCount,
-                    sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT
-                                           : GL_UNSIGNED_INT,
-                    (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx)),
-                    (GLint)pcmd->VtxOffset));
+            // Project scissor/clipping rectangles into framebuffer space
+            ImVec2 clipMin((pcmd->ClipRect.x - clipOff.x) * clipScale.x,
+                           (pcmd->ClipRect.y - clipOff.y) * clipScale.y);
+            ImVec2 clipMax((pcmd->ClipRect.z - clipOff.x) * clipScale.x,
+                           (pcmd->ClipRect.w - clipOff.y) * clipScale.y);
+            if (clipMax.x <= clipMin.x || clipMax.y <= clipMin.y)
+                continue;
+            ++g_frameCommands;
+
+            if (batched) {
+                batch.Add(*pcmd, globalIdxOffset, globalVtxOffset);
+                continue;
             }
+
+            // Apply scissor/clipping rectangle (Y is inverted in OpenGL)
+            state.Scissor((int)clipMin.x, (int)((float)fbHeight - clipMax.y),
+                          (int)(clipMax.x - clipMin.x),
+                          (int)(clipMax.y - clipMin.y));
+
+            // Bind texture, Draw
+            const auto texture = (GLuint)(intptr_t)pcmd->GetTexID();
+            state.BindTexture(0, texture);
+            const bool textureSdf = texture == g_fontTexture.Get()
+                && g_fontAtlasMode == ImGuiGLFontAtlasMode::Sdf;
+            if (textureSdf != sdf) {
+                sdf = textureSdf;
+                glUniform1i(g_sdfLoc, sdf);
+            }
+            GL_CALL(glDrawElementsBaseVertex(
+                GL_TRIANGLES, (GLsizei)pcmd->ElemCount,
+                sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+                (void*)(idxStart + globalIdxOffset
+                        + pcmd->IdxOffset * sizeof(ImDrawIdx)),
+                globalVtxOffset + (GLint)pcmd->VtxOffset));
+            ++g_frameDrawCalls;
         }
+        globalIdxOffset += drawList->IdxBuffer.Size * sizeof(ImDrawIdx);
+        globalVtxOffset += drawList->VtxBuffer.Size;
     }
-
-    // Destroy the temporary VAO
-    GL_CALL(glDeleteVertexArrays(1, &vertexArrayObject));
+    batch.Flush();
 
     // Restore modified GL state
-    // This "glIsProgram()" check is required because if the program is "pending
-    // deletion" at the time of binding backup, it will have been deleted by now
-    // and will cause an OpenGL error. See #6220.
-    if (lastProgram == 0 || glIsProgram(lastProgram))
-        glUseProgram(lastProgram);
-    glBindTexture(GL_TEXTURE_2D, lastTexture);
-    glBindSampler(0, lastSampler);
-    glActiveTexture(lastActiveTexture);
-    glBindVertexArray(lastVertexArrayObject);
-    glBindBuffer(GL_ARRAY_BUFFER, lastArrayBuffer);
-    glBlendEquationSeparate(lastBlendEquationRgb, lastBlendEquationAlpha);
-    glBlendFuncSeparate(lastBlendSrcRgb, lastBlendDstRgb, lastBlendSrcAlpha,
-                        lastBlendDstAlpha);
-    if (lastEnableBlend)
-        glEnable(GL_BLEND);
-    else
-        glDisable(GL_BLEND);
-    if (lastEnableCullFace)
-        glEnable(GL_CULL_FACE);
-    else
-        glDisable(GL_CULL_FACE);
-    if (lastEnableDepthTest)
-        glEnable(GL_DEPTH_TEST);
-    else
-        glDisable(GL_DEPTH_TEST);
-    if (lastEnableStencilTest)
-        glEnable(GL_STENCIL_TEST);
-    else
-        glDisable(GL_STENCIL_TEST);
-    if (lastEnableScissorTest)
-        glEnable(GL_SCISSOR_TEST);
-    else
-        glDisable(GL_SCISSOR_TEST);
-    if (lastEnablePrimitiveRestart)
-        glEnable(GL_PRIMITIVE_RESTART);
-    else
-        glDisable(GL_PRIMITIVE_RESTART);
-
-    // Desktop OpenGL 3.0 and OpenGL 3.1 had separate polygon draw modes for
-    // front-facing and back-facing faces of polygons
-    glPolygonMode(GL_FRONT_AND_BACK, (GLenum)lastPolygonMode[0]);
-
-    glViewport(lastViewport[0], lastViewport[1], (GLsizei)lastViewport[2],
-               (GLsizei)lastViewport[3]);
-    glScissor(lastScissorBox[0], lastScissorBox[1], (GLsizei)lastScissorBox[2],
-              (GLsizei)lastScissorBox[3]);
+    state.Restore(lastState);
+}
+
+// Signed distance field of an 8-bit coverage image: 0.5 + distance / (2 *
+// spread), distance in texels to the nearest texel on the other side of the
+// 50% coverage edge, positive inside. Brute force over a (2 * spread + 1)^2
+// window, run once per atlas build.
+static std::vector<uint8_t> BuildDistanceField(const uint8_t* coverage,
+                                               int width, int height,
+                                               int spread)
+{
+    std::vector<uint8_t> field((size_t)width * height);
+    const auto inside = [&](int x, int y) {
+        return coverage[(size_t)y * width + x] >= 128;
+    };
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const bool in = inside(x, y);
+            int        minDist2 = spread * spread + 1;
+            for (int dy = -spread; dy <= spread; ++dy) {
+                const int sy = y + dy;
+                if (sy < 0 || sy >= height) {
+                    continue;
+                }
+                for (int dx = -spread; dx <= spread; ++dx) {
+                    const int sx = x + dx;
+                    const int dist2 = dx * dx + dy * dy;
+                    if (sx < 0 || sx >= width || dist2 >= minDist2) {
+                        continue;
+                    }
+                    if (inside(sx, sy) != in) {
+                        minDist2 = dist2;
+                    }
+                }
+            }
+            // the edge lies half way between the two texel centers
+            const float dist = sqrtf((float)minDist2) - 0.5f;
+            const float value
+                = 0.5f + (in ? dist : -dist) / (2.0f * (float)spread);
+            field[(size_t)y * width + x]
+                = (uint8_t)(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+    return field;
+}
+
+void ImGuiGLPrepareFontAtlas(ImFontAtlas* atlas)
+{
+    if (g_fontAtlasMode == ImGuiGLFontAtlasMode::Sdf) {
+        // room for the distance field around every glyph; baked lines are
+        // coverage, not distances, so they would render wrong
+        atlas->TexGlyphPadding = ImGuiGLSdfSpread;
+        atlas->Flags |= ImFontAtlasFlags_NoBakedLines;
+    }
 }
 
 bool ImGuiGLCreateFontsTexture()
 {
-    ImGuiIO&     io = ImGui::GetIO();
-    ImGuiGLData* bd = ImGuiGLGetBackendData();
+    ImGuiIO& io = ImGui::GetIO();
 
-    // Build texture atlas
     unsigned char* pixels;
     int            width, height;
-    io.Fonts->GetTexDataAsRGBA32(
-        &pixels, &width,
-        &height); // Load as RGBA 32-bit (75% of the memory is wasted, but
-                  // default font is so small) because it is more likely to be
-                  // compatible with user's existing shaders. If your
-                  // ImTextureId represent a higher-level concept than just a GL
-                  // texture id, consider calling GetTexDataAsAlpha8() instead
-                  // to save on GPU memory.
+    GLenum         internalFormat = GL_RGBA8;
+    GLenum         format = GL_RGBA;
+    GLsizeiptr     bytes = 0;
+    const auto     start = std::chrono::steady_clock::now();
+
+    // Single channel atlases are read through a swizzle as white with the
+    // channel as alpha, so the shaders do not care which one is bound
+    std::vector<uint8_t> distanceField;
+    if (g_fontAtlasMode == ImGuiGLFontAtlasMode::RGBA32) {
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        bytes = (GLsizeiptr)width * height * 4;
+    } else {
+        io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+        internalFormat = GL_R8;
+        format = GL_RED;
+        bytes = (GLsizeiptr)width * height;
+        if (g_fontAtlasMode == ImGuiGLFontAtlasMode::Sdf) {
+            distanceField
+                = BuildDistanceField(pixels, width, height, ImGuiGLSdfSpread);
+            pixels = distanceField.data();
+        }
+    }
 
     // Upload texture to graphics system
     // (Bilinear sampling is required by default. Set 'io.Fonts->Flags |=
     // ImFontAtlasFlags_NoBakedLines' or 'style.AntiAliasedLinesUseTex = false'
     // to allow point/nearest sampling)
-    GLint lastTexture;
-    GL_CALL(glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexture));
-    GL_CALL(glGenTextures(1, &g_fontTexture));
-    GL_CALL(glBindTexture(GL_TEXTURE_2D, g_fontTexture));
-    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-    GL_CALL(
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-    GL_CALL(
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    g_fontTexture = GL::Texture::Create(nullptr);
+    GL_CALL(glTextureParameteri(g_fontTexture.Get(), GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+    GL_CALL(glTextureParameteri(g_fontTexture.Get(), GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    GL_CALL(glTextureParameteri(g_fontTexture.Get(), GL_TEXTURE_WRAP_S,
+                                GL_CLAMP_TO_EDGE));
+    GL_CALL(glTextureParameteri(g_fontTexture.Get(), GL_TEXTURE_WRAP_T,
+                                GL_CLAMP_TO_EDGE));
+    if (format == GL_RED) {
+        static constexpr GLint swizzle[] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
+        GL_CALL(glTextureParameteriv(g_fontTexture.Get(), GL_TEXTURE_SWIZZLE_RGBA,
+                                     swizzle));
+    }
+    GL_CALL(glTextureStorage2D(g_fontTexture.Get(), 1, internalFormat, width, height));
     GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
-    GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA,
-                         GL_UNSIGNED_BYTE, pixels));
-
-    // Restore state
-    GL_CALL(glBindTexture(GL_TEXTURE_2D, lastTexture));
+    GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    GL_CALL(glTextureSubImage2D(g_fontTexture.Get(), 0, 0, 0, width, height,
+                                format, GL_UNSIGNED_BYTE, pixels));
+    g_fontTexture.SetBytes(bytes);
+    GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+
+    // the distance field decode needs the atlas size in texels
+    const GLfloat atlasSize[] = { (GLfloat)width, (GLfloat)height };
+    for (const auto program : { g_shaderHandle, g_batchShaderHandle }) {
+        if (program) {
+            glProgramUniform2fv(program,
+                                glGetUniformLocation(program, "FontAtlasSize"),
+                                1, atlasSize);
+            glProgramUniform1f(program,
+                               glGetUniformLocation(program, "SdfSpread"),
+                               (GLfloat)ImGuiGLSdfSpread);
+        }
+    }
 
+    SPDLOG_INFO("font atlas {}x{} {} {} bytes, built in {:.2f}ms", width,
+                height, ToString(g_fontAtlasMode), bytes,
+                std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count());
     return true;
 }
 
 void ImGuiGLDestroyFontsTexture()
 {
-    if (g_fontTexture) {
-        glDeleteTextures(1, &g_fontTexture);
-        g_fontTexture = 0;
-    }
+    // contexts may still have frames in flight that sample it
+    g_fontTexture.Reset();
 }
 
+// Decodes a texel of the distance field font atlas: 0.5 + distance /
+// (2 * SdfSpread) with the distance in atlas texels. The edge is smoothed
+// over one screen pixel, whatever the scale the atlas is drawn at.
+#define IMGUI_GL_SDF_GLSL                                                      \
+    "uniform vec2 FontAtlasSize;\n"                                           \
+    "uniform float SdfSpread;\n"                                              \
+    "vec4 SdfTexel(float value, vec2 dx, vec2 dy)\n"                          \
+    "{\n"                                                                     \
+    "    float texels = length(vec2(length(dx * FontAtlasSize),\n"           \
+    "                                length(dy * FontAtlasSize))) * 0.7071;\n" \
+    "    float dist = (value - 0.5) * 2.0 * SdfSpread;\n"                     \
+    "    float alpha = clamp(dist / max(texels, 1e-5) + 0.5, 0.0, 1.0);\n"   \
+    "    return vec4(1.0, 1.0, 1.0, alpha);\n"                                \
+    "}\n"
+
 bool ImGuiGLCreateShader()
 {
     if (g_shaderHandle) {
@@ -494,38 +722,124 @@ bool ImGuiGLCreateShader()
           "in vec2 Frag_UV;\n"
           "in vec4 Frag_Color;\n"
           "uniform sampler2D Texture;\n"
+          "uniform bool Sdf;\n"
           "layout (location = 0) out vec4 Out_Color;\n"
+          IMGUI_GL_SDF_GLSL
           "void main()\n"
           "{\n"
-          "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+          "    vec4 texel = texture(Texture, Frag_UV.st);\n"
+          "    if (Sdf)\n"
+          "        texel = SdfTexel(texel.a, dFdx(Frag_UV), dFdy(Frag_UV));\n"
+          "    Out_Color = Frag_Color * texel;\n"
           "}\n";
 
-    g_shaderHandle = GL::CreateShader(vertexShader, fragmentShader);
-    return g_shaderHandle != 0;
+    static constexpr const GLchar* batchVertexShader
+        = "#version 460\n"
+          "layout (location = 0) in vec2 Position;\n"
+          "layout (location = 1) in vec2 UV;\n"
+          "layout (location = 2) in vec4 Color;\n"
+          "struct Draw\n"
+          "{\n"
+          "    vec4 clipRect;\n"
+          "    uint textureSlot;\n"
+          "};\n"
+          "layout (std430, binding = 0) readonly buffer Draws\n"
+          "{\n"
+          "    Draw draws[];\n"
+          "};\n"
+          "uniform mat4 ProjMtx;\n"
+          "uniform uint DrawBase;\n"
+          "out float gl_ClipDistance[4];\n"
+          "out vec2 Frag_UV;\n"
+          "out vec4 Frag_Color;\n"
+          "flat out uint Frag_TextureSlot;\n"
+          "void main()\n"
+          "{\n"
+          "    Draw draw = draws[DrawBase + gl_DrawID];\n"
+          "    gl_ClipDistance[0] = Position.x - draw.clipRect.x;\n"
+          "    gl_ClipDistance[1] = draw.clipRect.z - Position.x;\n"
+          "    gl_ClipDistance[2] = Position.y - draw.clipRect.y;\n"
+          "    gl_ClipDistance[3] = draw.clipRect.w - Position.y;\n"
+          "    Frag_UV = UV;\n"
+          "    Frag_Color = Color;\n"
+          "    Frag_TextureSlot = draw.textureSlot;\n"
+          "    gl_Position = ProjMtx * vec4(Position.xy,0,1);\n"
+          "}\n";
+
+    // The slot is not dynamically uniform in the fragment shader, so every
+    // sampler is indexed with a constant and the derivatives are taken
+    // outside of the switch.
+    static constexpr const GLchar* batchFragmentShader
+        = "#version 460\n"
+          "in vec2 Frag_UV;\n"
+          "in vec4 Frag_Color;\n"
+          "flat in uint Frag_TextureSlot;\n"
+          "uniform sampler2D Textures[8];\n"
+          "layout (location = 0) out vec4 Out_Color;\n"
+          IMGUI_GL_SDF_GLSL
+          "#define SLOT(i) case i: "
+          "texel = textureGrad(Textures[i], Frag_UV, dx, dy); break;\n"
+          "void main()\n"
+          "{\n"
+          "    vec2 dx = dFdx(Frag_UV);\n"
+          "    vec2 dy = dFdy(Frag_UV);\n"
+          "    vec4 texel = vec4(1.0);\n"
+          "    switch (Frag_TextureSlot & 0xFFu) {\n"
+          "    SLOT(0) SLOT(1) SLOT(2) SLOT(3)\n"
+          "    SLOT(4) SLOT(5) SLOT(6) SLOT(7)\n"
+          "    }\n"
+          "    if ((Frag_TextureSlot & 0x100u) != 0u)\n"
+          "        texel = SdfTexel(texel.a, dx, dy);\n"
+          "    Out_Color = Frag_Color * texel;\n"
+          "}\n";
+    static_assert(BatchTextureSlots == 8, "update Textures[] and SLOT()s");
+
+    // both are started before either is waited for, so they compile together
+    GL::PendingProgram program(vertexShader, fragmentShader);
+    GL::PendingProgram batchProgram(batchVertexShader, batchFragmentShader);
+
+    g_shaderHandle = program.Release();
+    if (!g_shaderHandle) {
+        return false;
+    }
+    g_sdfLoc = glGetUniformLocation(g_shaderHandle, "Sdf");
+
+    g_batchShaderHandle = batchProgram.Release();
+    if (!g_batchShaderHandle) {
+        // the unbatched path still works
+        SPDLOG_ERROR("batched ImGui shader failed, drawing unbatched");
+        return true;
+    }
+    g_batchProjMtxLoc = glGetUniformLocation(g_batchShaderHandle, "ProjMtx");
+    g_batchDrawBaseLoc = glGetUniformLocation(g_batchShaderHandle, "DrawBase");
+    const GLint slots[BatchTextureSlots] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    glProgramUniform1iv(g_batchShaderHandle,
+                        glGetUniformLocation(g_batchShaderHandle, "Textures"),
+                        BatchTextureSlots, slots);
+    return true;
 }
 
 void ImGuiGLDestroyShader()
 {
+    auto& state = GL::GetStateCache();
     if (g_shaderHandle) {
         glDeleteProgram(g_shaderHandle);
+        state.OnDeleted(GL_PROGRAM, g_shaderHandle);
         g_shaderHandle = 0;
     }
+    if (g_batchShaderHandle) {
+        glDeleteProgram(g_batchShaderHandle);
+        state.OnDeleted(GL_PROGRAM, g_batchShaderHandle);
+        g_batchShaderHandle = 0;
+    }
 }
 
+// All windows render with one shared context, so the vertex array of an
+// ImGui context lives as long as the context and is set up only once.
 bool ImGuiGLCreateDeviceObjects()
 {
     ImGuiGLData* bd = ImGuiGLGetBackendData();
 
-    // Backup GL state
-    GLint lastTexture, lastArrayBuffer;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexture);
-    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &lastArrayBuffer);
-    GLint lastPixelUnpackBuffer = 0;
-    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &lastPixelUnpackBuffer);
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-    GLint lastVertexArray;
-    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &lastVertexArray);
-
     bd->attribLocationTex = glGetUniformLocation(g_shaderHandle, "Texture");
     bd->attribLocationProjMtx = glGetUniformLocation(g_shaderHandle, "ProjMtx");
     bd->attribLocationVtxPos
@@ -534,15 +848,32 @@ bool ImGuiGLCreateDeviceObjects()
     bd->attribLocationVtxColor
         = (GLuint)glGetAttribLocation(g_shaderHandle, "Color");
 
-    // Create buffers
-    glGenBuffers(1, &bd->vboHandle);
-    glGenBuffers(1, &bd->elementsHandle);
-
-    // Restore modified GL state
-    glBindTexture(GL_TEXTURE_2D, lastTexture);
-    glBindBuffer(GL_ARRAY_BUFFER, lastArrayBuffer);
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, lastPixelUnpackBuffer);
-    glBindVertexArray(lastVertexArray);
+    // Setup attributes for ImDrawVert, all read from binding 0. The buffer
+    // is bound per frame, at the offset the frame's vertices were copied to.
+    bd->vertexArray = GL::VertexArray::Create(ImGui::GetCurrentContext());
+    const GLuint vao = bd->vertexArray.Get();
+    const struct
+    {
+        GLuint    location;
+        GLint     size;
+        GLenum    type;
+        GLboolean normalized;
+        GLuint    offset;
+    } attribs[] = {
+        { bd->attribLocationVtxPos, 2, GL_FLOAT, GL_FALSE,
+          (GLuint)offsetof(ImDrawVert, pos) },
+        { bd->attribLocationVtxUv, 2, GL_FLOAT, GL_FALSE,
+          (GLuint)offsetof(ImDrawVert, uv) },
+        { bd->attribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+          (GLuint)offsetof(ImDrawVert, col) },
+    };
+    for (const auto& attrib : attribs) {
+        glEnableVertexArrayAttrib(vao, attrib.location);
+        GL_CALL(glVertexArrayAttribFormat(vao, attrib.location, attrib.size,
+                                          attrib.type, attrib.normalized,
+                                          attrib.offset));
+        glVertexArrayAttribBinding(vao, attrib.location, 0);
+    }
 
     return true;
 }
@@ -550,14 +881,9 @@ bool ImGuiGLCreateDeviceObjects()
 void ImGuiGLDestroyDeviceObjects()
 {
     ImGuiGLData* bd = ImGuiGLGetBackendData();
-    if (bd->vboHandle) {
-        glDeleteBuffers(1, &bd->vboHandle);
-        bd->vboHandle = 0;
-    }
-    if (bd->elementsHandle) {
-        glDeleteBuffers(1, &bd->elementsHandle);
-        bd->elementsHandle = 0;
-    }
+    // the window's last frames may still be in flight
+    bd->vertexArray.Reset();
+    bd->streamGeneration = 0;
     ImGuiIO& io = ImGui::GetIO();
     io.Fonts->SetTexID(0);
 }
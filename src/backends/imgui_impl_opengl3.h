@@ -2,7 +2,41 @@
 #include "imgui.h" // IMGUI_IMPL_API
 #ifndef IMGUI_DISABLE
 
-bool ImGuiGLInit();
+#include <stdint.h>
+
+// framesInFlight and frameIndex as in GL::FrameFences, vertex data of a frame
+// goes into a region of a ring that is only reused frameInFlight frames later
+bool ImGuiGLInit(uint32_t framesInFlight);
+// Once per frame, before any ImGuiGLRenderDrawData.
+void ImGuiGLBeginFrame(uint32_t frameIndex);
+
+// Batching (default on) clips in the shader and merges runs of draw
+// commands into multi-draws. Off - one draw call per command.
+void ImGuiGLSetBatching(bool batching);
+bool ImGuiGLIsBatching();
+
+// Font atlas texture format, set before the first context is initialized.
+enum class ImGuiGLFontAtlasMode
+{
+    RGBA32, // white RGB, coverage in alpha
+    Alpha8, // R8 coverage read through a swizzle, a quarter of the memory
+    Sdf,    // R8 signed distance field, stays sharp at any scale
+};
+constexpr int ImGuiGLSdfSpread = 4; // distance field range in texels
+
+void                 ImGuiGLSetFontAtlasMode(ImGuiGLFontAtlasMode mode);
+ImGuiGLFontAtlasMode ImGuiGLGetFontAtlasMode();
+const char*          ToString(ImGuiGLFontAtlasMode mode);
+// Sets up the atlas for the mode, call before adding fonts and building.
+void ImGuiGLPrepareFontAtlas(ImFontAtlas* atlas);
+
+struct ImGuiGLFrameStats
+{
+    uint64_t commands = 0;  // visible ImDrawCmds, one draw call each unbatched
+    uint64_t drawCalls = 0; // issued draw calls
+};
+// Totals of all windows in the last finished frame, any thread.
+ImGuiGLFrameStats ImGuiGLGetLastFrameStats();
 bool ImGuiGLInitContext();
 void ImGuiGLShutdown();
 void ImGuiGLShutdownContext();
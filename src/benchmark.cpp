@@ -0,0 +1,207 @@
+#include "benchmark.h"
+#include "gl/call_counter.h"
+
+#include <SDL3/SDL.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <iterator>
+#include <numeric>
+#include <string_view>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+static uint64_t GetPeakRssBytes()
+{
+#if !defined(_WIN32)
+    rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return (uint64_t)usage.ru_maxrss * 1024; // kilobytes on Linux
+    }
+#endif
+    return 0;
+}
+
+// Contents of a JSON string literal, without the quotes.
+static std::string EscapeJson(std::string_view str)
+{
+    std::string out;
+    out.reserve(str.size());
+    for (const char c : str) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                std::format_to(std::back_inserter(out), "\\u{:04x}",
+                               (unsigned)c);
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out;
+}
+
+static void AppendDistribution(std::string& out, std::vector<uint64_t> ns)
+{
+    if (ns.empty()) {
+        out += "null";
+        return;
+    }
+    std::sort(ns.begin(), ns.end());
+    auto percentile = [&](double p) {
+        return ns[(size_t)(p * (double)(ns.size() - 1) + 0.5)] / 1e6;
+    };
+    const auto sum = std::accumulate(ns.begin(), ns.end(), 0.0);
+    std::format_to(std::back_inserter(out),
+                   "{{\"count\": {}, \"mean_ms\": {:.4f}, \"min_ms\": {:.4f}, "
+                   "\"p50_ms\": {:.4f}, \"p90_ms\": {:.4f}, "
+                   "\"p95_ms\": {:.4f}, \"p99_ms\": {:.4f}, "
+                   "\"max_ms\": {:.4f}}}",
+                   ns.size(), sum / (double)ns.size() / 1e6, ns.front() / 1e6,
+                   percentile(0.50), percentile(0.90), percentile(0.95),
+                   percentile(0.99), ns.back() / 1e6);
+}
+
+Benchmark::Benchmark(Config config)
+    : config_(std::move(config))
+{
+    // the last warm-up frame marks the start of the measurement
+    config_.warmupFrames = std::max(config_.warmupFrames, 1);
+    config_.frames = std::max(config_.frames, 1);
+}
+
+bool Benchmark::OnFrame(const FrameStats& stats)
+{
+    ++frame_;
+    if (frame_ == config_.warmupFrames) {
+        Start(stats);
+        return false;
+    }
+    if (frame_ < config_.warmupFrames) {
+        return false;
+    }
+
+    const auto now = SDL_GetTicksNS();
+    intervals_.push_back(now - lastFrameNs_);
+    lastFrameNs_ = now;
+    Collect(stats);
+
+    if (frame_ < config_.warmupFrames + config_.frames) {
+        return false;
+    }
+    endNs_ = now;
+    WriteReport();
+    return true;
+}
+
+void Benchmark::Start(const FrameStats& stats)
+{
+    for (size_t i = 0; i < StageCount; ++i) {
+        cursors_[i] = stats.GetCount((FrameStage)i);
+        samples_[i].reserve(config_.frames);
+    }
+    intervals_.reserve(config_.frames);
+    GL::ResetCallCounters();
+    startNs_ = lastFrameNs_ = SDL_GetTicksNS();
+}
+
+void Benchmark::Collect(const FrameStats& stats)
+{
+    for (size_t i = 0; i < StageCount; ++i) {
+        const auto stage = (FrameStage)i;
+        const auto count = stats.GetCount(stage);
+        // we are called every frame, so the ring can not have wrapped
+        for (; cursors_[i] < count; ++cursors_[i]) {
+            samples_[i].push_back(stats.GetSample(stage, cursors_[i]));
+        }
+    }
+}
+
+std::string Benchmark::BuildReport() const
+{
+    const auto seconds = (endNs_ - startNs_) / 1e9;
+
+    std::string out;
+    auto        it = std::back_inserter(out);
+    std::format_to(it,
+                   "{{\n  \"canvas\": \"{}\",\n  \"width\": {},\n"
+                   "  \"height\": {},\n  \"vsync\": {},\n  \"headless\": {},\n"
+                   "  \"warmup_frames\": {},\n  \"frames\": {},\n"
+                   "  \"seconds\": {:.4f},\n  \"fps\": {:.2f},\n",
+                   EscapeJson(config_.canvas), config_.width, config_.height,
+                   config_.vsync, config_.headless, config_.warmupFrames,
+                   config_.frames, seconds,
+                   seconds > 0.0 ? config_.frames / seconds : 0.0);
+
+    out += "  \"frame_interval\": ";
+    AppendDistribution(out, intervals_);
+    out += ",\n  \"stages\": {";
+    for (size_t i = 0; i < StageCount; ++i) {
+        std::format_to(it, "{}\n    \"{}\": ", i ? "," : "",
+                       EscapeJson(ToString((FrameStage)i)));
+        AppendDistribution(out, samples_[i]);
+    }
+    out += "\n  },\n";
+
+    out += "  \"gl_calls\": {";
+    if (GL::AreCallCountersInstalled()) {
+        bool first = true;
+        for (size_t i = 0; i < (size_t)GL::CallCategory::Count; ++i) {
+            const auto category = (GL::CallCategory)i;
+            std::format_to(it, "{}\n    \"{}_per_frame\": {:.2f}",
+                           first ? "" : ",",
+                           EscapeJson(GL::ToString(category)),
+                           GL::GetCallCount(category) / (double)config_.frames);
+            first = false;
+        }
+        GL::ForEachCallCount(
+            [&](const char* name, GL::CallCategory, uint64_t count) {
+                if (count) {
+                    std::format_to(it, ",\n    \"{}\": {}",
+                                   EscapeJson(name), count);
+                }
+            });
+    }
+    out += "\n  },\n";
+
+    std::format_to(it, "  \"peak_rss_bytes\": {}\n}}\n", GetPeakRssBytes());
+    return out;
+}
+
+void Benchmark::WriteReport() const
+{
+    const auto report = BuildReport();
+    if (config_.reportPath.empty()) {
+        std::fputs(report.c_str(), stdout);
+        std::fflush(stdout);
+        return;
+    }
+
+    auto* file = std::fopen(config_.reportPath.c_str(), "w");
+    if (!file) {
+        SPDLOG_ERROR("failed to open benchmark report '{}'", config_.reportPath);
+        return;
+    }
+    std::fputs(report.c_str(), file);
+    std::fclose(file);
+    SPDLOG_INFO("benchmark report written to '{}'", config_.reportPath);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "frame_stats.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Collects the complete frame history of a single window over a fixed
+// number of frames (after a warm-up) and writes a JSON report with the
+// frame-time distribution per stage, GPU time, GL call counts and peak RSS.
+class Benchmark
+{
+public:
+    struct Config
+    {
+        std::string canvas;
+        int         warmupFrames = 60;
+        int         frames = 600;
+        bool        vsync = false;
+        int         width = 0;
+        int         height = 0;
+        bool        headless = false;
+        std::string reportPath; // stdout when empty
+    };
+
+    explicit Benchmark(Config config);
+
+    const Config& GetConfig() const { return config_; }
+
+    // Called after every frame of the benchmarked window. Returns true once
+    // all measured frames are collected and the report has been written.
+    bool OnFrame(const FrameStats& stats);
+
+private:
+    void        Start(const FrameStats& stats);
+    void        Collect(const FrameStats& stats);
+    std::string BuildReport() const;
+    void        WriteReport() const;
+
+private:
+    static constexpr size_t StageCount = (size_t)FrameStage::Count;
+
+    Config config_;
+    int    frame_ = 0;
+
+    std::array<std::vector<uint64_t>, StageCount> samples_;
+    std::array<uint64_t, StageCount>              cursors_ = {};
+    std::vector<uint64_t>                         intervals_;
+    uint64_t                                      lastFrameNs_ = 0;
+    uint64_t                                      startNs_ = 0;
+    uint64_t                                      endNs_ = 0;
+};
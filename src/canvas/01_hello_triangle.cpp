@@ -1,4 +1,5 @@
 #include "01_hello_triangle.h"
+#include "app.h"
 #include "gl/framework.h"
 #include "utils.h"
 
@@ -7,47 +8,41 @@
 
 HelloTriangleCanvas::HelloTriangleCanvas() 
 {
-    shader_ = GL::CreateShader(
-        R"(#version 460 core
-        void main()
-        {
-            vec2 points[3] = vec2[3](
-                vec2(-0.7, -0.7),
-                vec2(0.0, 0.7),
-                vec2(0.7, -0.7)
-            );
-            gl_Position = vec4(points[gl_VertexID], 0.0, 1.0);
-        })",
-        R"(#version 460 core
-        out vec4 color;
-        void main()
-        {
-            color = vec4(1.0, 0.0, 0.0, 1.0);
-        })"
-    );
+    SetUpdatePolicy(UpdatePolicy::Static);
+    SetBuildUIThreadSafe(true);
+    shader_ = App::GetShaderLibrary()->Load("hello_triangle.vert", "hello_triangle.frag");
 }
 
 HelloTriangleCanvas::~HelloTriangleCanvas() 
 {
-    glDeleteProgram(shader_);
 }
 
 void HelloTriangleCanvas::BuildUI()
 {
-    static int a;
     ImGui::Begin("Hello window");
     ImGui::Text("hello pretty ui");
-    ImGui::DragInt("int", &a);
+    ImGui::DragInt("int", &value_);
     ImGui::End();
 }
 
-void HelloTriangleCanvas::Render()
+void HelloTriangleCanvas::Render() { RecordRender()(); }
+
+std::function<void()> HelloTriangleCanvas::RecordRender()
 {
     const auto size = ImGui::GetMainViewport()->Size;
-    glViewport(0, 0, size.x, size.y);
-    glClearColor(bgColor_.r, bgColor_.g, bgColor_.b, bgColor_.a);
-    glClear(GL_COLOR_BUFFER_BIT);
+    return [this, size, bgColor = bgColor_]() {
+        auto& state = GL::GetStateCache();
+        state.Viewport(0, 0, size.x, size.y);
+        glClearColor(bgColor.r, bgColor.g, bgColor.b, bgColor.a);
+        glClear(GL_COLOR_BUFFER_BIT);
 
-    glUseProgram(shader_);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+        // only the background until the program is linked, the app
+        // redraws every window when it is
+        const auto shader = shader_->Get();
+        if (!shader) {
+            return;
+        }
+        state.UseProgram(shader);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    };
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "canvas.h"
+#include "gl/shader_library.h"
 #include "utils.h"
 
 #include <glad/glad.h>
@@ -13,8 +14,10 @@ public:
 
     void BuildUI() override;
     void Render() override;
+    std::function<void()> RecordRender() override;
 
 private:
-    GLuint shader_;
+    GL::ShaderProgram* shader_ = nullptr; // owned by the shader library
     Color bgColor_ = Utils::GetNextColorFromPalette();
+    int value_ = 0;
 };
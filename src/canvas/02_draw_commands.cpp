@@ -1,34 +1,18 @@
 #include "02_draw_commands.h"
+#include "app.h"
 #include "gl/framework.h"
+#include "gl/uniform_arena.h"
 
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <imgui.h>
 
 DrawCommandsCanvas::DrawCommandsCanvas() 
 {
+    SetUpdatePolicy(UpdatePolicy::Static);
+    SetBuildUIThreadSafe(true);
     bgColor_ = Color::Convert(0xB0BEC5ff);
-    shader_ = GL::CreateShader(
-        R"(#version 460 core
-        layout (location = 0) in vec4 vPos;
-        layout (location = 1) in vec4 vColor;
-        out vec4 fColor;
-        uniform mat4 model;
-        uniform mat4 projection;
-        void main()
-        {
-            fColor = vColor;
-            gl_Position = projection * (model * vPos);
-        })",
-        R"(#version 460 core
-        in vec4 fColor;
-        out vec4 color;
-        void main()
-        {
-            color = fColor;
-        })"
-    );
-    modelLoc_ = glGetUniformLocation(shader_, "model");
-    projectionLoc_ = glGetUniformLocation(shader_, "projection");
+    shader_ = App::GetShaderLibrary()->Load("draw_commands.vert", "draw_commands.frag");
 
     // A single triangle
     static const GLfloat vertexPositions[] =
@@ -50,38 +34,37 @@ DrawCommandsCanvas::DrawCommandsCanvas()
 
     static const GLuint indices[] = { 0, 1, 2, 1, 2, 3 };
 
-    glGenBuffers(1, &vboVertices_);
-    glBindBuffer(GL_ARRAY_BUFFER, vboVertices_);
+    auto& state = GL::GetStateCache();
+    vboVertices_ = GL::Buffer::Create(this);
+    state.BindBuffer(GL_ARRAY_BUFFER, vboVertices_.Get());
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertexPositions), vertexPositions, GL_STATIC_DRAW);
-    glGenBuffers(1, &vboColors_);
-    glBindBuffer(GL_ARRAY_BUFFER, vboColors_);
+    vboVertices_.SetBytes(sizeof(vertexPositions));
+    vboColors_ = GL::Buffer::Create(this);
+    state.BindBuffer(GL_ARRAY_BUFFER, vboColors_.Get());
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertexColors), vertexColors, GL_STATIC_DRAW);
-    glGenBuffers(1, &ebo_);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    vboColors_.SetBytes(sizeof(vertexColors));
+    ebo_ = GL::Buffer::Create(this);
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_.Get());
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    ebo_.SetBytes(sizeof(indices));
     
-    glGenVertexArrays(1, &vao_);
-    glBindVertexArray(vao_);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-    glBindBuffer(GL_ARRAY_BUFFER, vboVertices_);
+    vao_ = GL::VertexArray::Create(this);
+    state.BindVertexArray(vao_.Get());
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_.Get());
+    state.BindBuffer(GL_ARRAY_BUFFER, vboVertices_.Get());
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
     glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vboColors_);
+    state.BindBuffer(GL_ARRAY_BUFFER, vboColors_.Get());
     glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, nullptr); // tightly packed, same as 4 * sizeof(float)
     glEnableVertexAttribArray(1);
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    state.BindVertexArray(0);
+    state.BindBuffer(GL_ARRAY_BUFFER, 0);
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 DrawCommandsCanvas::~DrawCommandsCanvas() 
 {
-    glDeleteBuffers(1, &ebo_);
-    glDeleteBuffers(1, &vboVertices_);
-    glDeleteBuffers(1, &vboColors_);
-    glDeleteBuffers(1, &vao_);
-    glDeleteProgram(shader_);
 }
 
 using mat4 = DrawCommandsCanvas::mat4;
@@ -134,37 +117,63 @@ void DrawCommandsCanvas::BuildUI()
     viewportOffsetX_ = viewportOffsetX_ > maxOffset ? maxOffset : viewportOffsetX_;
 }
 
-void DrawCommandsCanvas::Render()
+void DrawCommandsCanvas::Render() { RecordRender()(); }
+
+std::function<void()> DrawCommandsCanvas::RecordRender()
 {
     const auto size = ImGui::GetMainViewport()->Size;
-    glViewport(viewportOffsetX_, 0, size.x - viewportOffsetX_, size.y);
-    glClearColor(bgColor_.r, bgColor_.g, bgColor_.b, bgColor_.a);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    float model[] = {
-        1.0, 0.0, 0.0, -0.5,
-        0.0, 1.0, 0.0, 0.5,
-        0.0, 0.0, 1.0, debugDist_,
-        0.0, 0.0, 0.0, 1.0,
+    return [this, size, offsetX = viewportOffsetX_, bgColor = bgColor_,
+            debugDist = debugDist_, projection = projection_,
+            baseVertex = baseVertex_]() {
+        auto& state = GL::GetStateCache();
+        state.Viewport(offsetX, 0, size.x - offsetX, size.y);
+        glClearColor(bgColor.r, bgColor.g, bgColor.b, bgColor.a);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // only the background until the program is linked, the app
+        // redraws every window when it is
+        const auto shader = shader_->Get();
+        if (!shader) {
+            return;
+        }
+
+        // the constants are written straight into the arena, one block for
+        // the frame and one per draw, which each draw binds
+        auto* arena = GL::GetUniformArena();
+        auto  frame = arena->AllocateUniforms<FrameBlock>(1);
+        memcpy(glm::value_ptr(frame[0].projection), projection.data(), sizeof(projection));
+        const std::array<std::array<float, 2>, DrawCount> offsets = {{
+            {-0.5f, 0.5f},
+            {0.5f, 0.5f},
+            {-0.5f, -0.5f},
+            {0.5f, -0.5f},
+        }};
+        auto draws = arena->AllocateUniforms<DrawBlock>(DrawCount);
+        for (uint32_t i = 0; i < DrawCount; ++i) {
+            const mat4 model = {
+                1.0, 0.0, 0.0, offsets[i][0],
+                0.0, 1.0, 0.0, offsets[i][1],
+                0.0, 0.0, 1.0, debugDist,
+                0.0, 0.0, 0.0, 1.0,
+            };
+            memcpy(glm::value_ptr(draws[i].model), model.data(), sizeof(model));
+        }
+
+        // GL objects never change after construction
+        state.BindVertexArray(vao_.Get());
+        state.UseProgram(shader);
+        frame.BindUniform(FrameBinding, 0);
+
+        draws.BindUniform(DrawBinding, 0);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        draws.BindUniform(DrawBinding, 1);
+        glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, 0);
+
+        draws.BindUniform(DrawBinding, 2);
+        glDrawElementsBaseVertex(GL_TRIANGLES, 3, GL_UNSIGNED_INT, 0, baseVertex);
+
+        draws.BindUniform(DrawBinding, 3);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 3, 1);
     };
-
-    glBindVertexArray(vao_);
-    glUseProgram(shader_);
-    glUniformMatrix4fv(projectionLoc_, 1, GL_TRUE, projection_.data()); // gl uses col major so we need to transpose it
-
-    glUniformMatrix4fv(modelLoc_, 1, GL_TRUE, model);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-
-    model[3] = 0.5;
-    glUniformMatrix4fv(modelLoc_, 1, GL_TRUE, model);
-    glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, 0);
-    
-    model[3] = -0.5;
-    model[7] = -0.5;
-    glUniformMatrix4fv(modelLoc_, 1, GL_TRUE, model);
-    glDrawElementsBaseVertex(GL_TRIANGLES, 3, GL_UNSIGNED_INT, 0, baseVertex_);
-
-    model[3] = 0.5;
-    glUniformMatrix4fv(modelLoc_, 1, GL_TRUE, model); // gl uses col major so we need to transpose it
-    glDrawArraysInstanced(GL_TRIANGLES, 0, 3, 1);
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "canvas.h"
+#include "gl/block_layout.h"
+#include "gl/shader_library.h"
 #include "utils.h"
 
 #include <array>
@@ -16,11 +18,27 @@ public:
 
     void BuildUI() override;
     void Render() override;
+    std::function<void()> RecordRender() override;
 
 private:
-    GLuint shader_ = 0;
-    GLuint modelLoc_ = 0;
-    GLuint projectionLoc_ = 0;
+    // the Frame and Draw blocks of draw_commands.vert, row major
+    struct FrameBlock
+    {
+        glm::mat4 projection;
+    };
+    struct DrawBlock
+    {
+        glm::mat4 model;
+    };
+    static_assert(GL::CheckLayout<GL::BlockLayout::Std140, FrameBlock>(
+        GL_LAYOUT_MEMBER(FrameBlock, projection)));
+    static_assert(GL::CheckLayout<GL::BlockLayout::Std140, DrawBlock>(
+        GL_LAYOUT_MEMBER(DrawBlock, model)));
+    static constexpr GLuint FrameBinding = 0;
+    static constexpr GLuint DrawBinding = 1;
+    static constexpr uint32_t DrawCount = 4;
+
+    GL::ShaderProgram* shader_ = nullptr; // owned by the shader library
 
     float debugDist_ = -1.0f;
     float near_ = 0.001;
@@ -28,13 +46,14 @@ private:
     bool  projectionCalc_ = true;
     mat4  projection_ = { 0 };
 
-    GLuint vao_ = 0;
-    GLuint vboVertices_ = 0;
-    GLuint vboColors_ = 0;
-    GLuint ebo_ = 0;
+    GL::VertexArray vao_;
+    GL::Buffer      vboVertices_;
+    GL::Buffer      vboColors_;
+    GL::Buffer      ebo_;
 
     GLuint baseVertex_ = 0;
 
     float viewportOffsetX_ = 0.0f;
     Color bgColor_ = {};
 };
+
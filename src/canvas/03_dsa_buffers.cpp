@@ -1,4 +1,5 @@
 #include "03_dsa_buffers.h"
+#include "app.h"
 #include "gl/framework.h"
 
 #include <imgui.h>
@@ -6,31 +7,14 @@
 
 DsaBuffersCanvas::DsaBuffersCanvas() 
 {
+    SetUpdatePolicy(UpdatePolicy::Static);
     bgColor_ = Color::Convert(0xB0BEC5ff);
-    shader_ = GL::CreateShader(
-        R"(#version 460 core
-        layout (location = 0) in vec2 vPos;
-        layout (location = 1) in vec3 vColor;
-        out vec3 fColor;
-        void main()
-        {
-            fColor = aColor;
-            gl_Position = vec4(vPos, 0.0, 1.0f);
-        })",
-        R"(#version 460 core
-        in vec3 fColor;
-        out vec4 color;
-        void main()
-        {
-            color = vec4(fColor, 1.0f);
-        })"
-    );
+    shader_ = App::GetShaderLibrary()->Load("dsa_buffers.vert", "dsa_buffers.frag");
 }
 
 DsaBuffersCanvas::~DsaBuffersCanvas() 
 {
     DestroyBuffers();
-    glDeleteProgram(shader_);
 }
 
 void DsaBuffersCanvas::BuildUI()
@@ -50,13 +34,15 @@ void DsaBuffersCanvas::BuildUI()
 void DsaBuffersCanvas::Render()
 {
     const auto size = ImGui::GetMainViewport()->Size;
-    glViewport(0, 0, size.x, size.y);
+    auto& state = GL::GetStateCache();
+    state.Viewport(0, 0, size.x, size.y);
     glClearColor(bgColor_.r, bgColor_.g, bgColor_.b, bgColor_.a);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    if (vao_) {
-        GL_CALL(glBindVertexArray(vao_));
-        GL_CALL(glUseProgram(shader_));  
+    const auto shader = shader_->Get(); // 0 until the program is linked
+    if (vao_ && shader) {
+        state.BindVertexArray(vao_.Get());
+        state.UseProgram(shader);
         GL_CALL(glDrawArrays(GL_TRIANGLES, 0, 3));
         // glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE, 0);
     }
@@ -84,57 +70,64 @@ void DsaBuffersCanvas::CreateBuffers()
 
 void DsaBuffersCanvas::CreateBuffersDsa(const GLfloat* vertices, const GLubyte* indices)
 {
-    glCreateBuffers(1, &vbo_);
-    glNamedBufferStorage(vbo_, sizeof(GLfloat) * 20, vertices, GL_DYNAMIC_STORAGE_BIT);
+    vbo_ = GL::Buffer::Create(this);
+    glNamedBufferStorage(vbo_.Get(), sizeof(GLfloat) * 20, vertices, GL_DYNAMIC_STORAGE_BIT);
+    vbo_.SetBytes(sizeof(GLfloat) * 20);
 
-    glCreateBuffers(1, &ebo_);
-    glNamedBufferStorage(ebo_, sizeof(GLubyte) * 6, indices, GL_DYNAMIC_STORAGE_BIT);
+    ebo_ = GL::Buffer::Create(this);
+    glNamedBufferStorage(ebo_.Get(), sizeof(GLubyte) * 6, indices, GL_DYNAMIC_STORAGE_BIT);
+    ebo_.SetBytes(sizeof(GLubyte) * 6);
     
-    glCreateVertexArrays(1, &vao_);
-    glVertexArrayVertexBuffer(vao_, 0, vbo_, 0, sizeof(float) * 5);
-    glVertexArrayElementBuffer(vao_, ebo_);
-
-    glEnableVertexArrayAttrib(vao_, 0);
-    glEnableVertexArrayAttrib(vao_, 1);
-    glVertexArrayAttribFormat(vao_, 0, 2, GL_FLOAT, GL_FALSE, 0);
-    glVertexArrayAttribFormat(vao_, 1, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat));
-    glVertexArrayAttribBinding(vao_, 0, 0);
-    glVertexArrayAttribBinding(vao_, 1, 0);
+    vao_ = GL::VertexArray::Create(this);
+    const auto vao = vao_.Get();
+    glVertexArrayVertexBuffer(vao, 0, vbo_.Get(), 0, sizeof(float) * 5);
+    glVertexArrayElementBuffer(vao, ebo_.Get());
+
+    glEnableVertexArrayAttrib(vao, 0);
+    glEnableVertexArrayAttrib(vao, 1);
+    glVertexArrayAttribFormat(vao, 0, 2, GL_FLOAT, GL_FALSE, 0);
+    glVertexArrayAttribFormat(vao, 1, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat));
+    glVertexArrayAttribBinding(vao, 0, 0);
+    glVertexArrayAttribBinding(vao, 1, 0);
 }
 
 void DsaBuffersCanvas::CreateBuffersNonDsa(const GLfloat* vertices, const GLubyte* indices)
 {
-    glGenBuffers(1, &vbo_);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    // glGen* only reserves names, the objects are created by the first bind
+    GLuint vbo, ebo, vao;
+    auto& state = GL::GetStateCache();
+    glGenBuffers(1, &vbo);
+    vbo_ = GL::Buffer(vbo, this);
+    state.BindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 20, vertices, GL_STATIC_DRAW);
+    vbo_.SetBytes(sizeof(GLfloat) * 20);
 
-    glGenBuffers(1, &ebo_);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    glGenBuffers(1, &ebo);
+    ebo_ = GL::Buffer(ebo, this);
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLubyte) * 6, indices, GL_STATIC_DRAW);
+    ebo_.SetBytes(sizeof(GLubyte) * 6);
     
-    glGenVertexArrays(1, &vao_);
-    glBindVertexArray(vao_);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glGenVertexArrays(1, &vao);
+    vao_ = GL::VertexArray(vao, this);
+    state.BindVertexArray(vao);
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    state.BindBuffer(GL_ARRAY_BUFFER, vbo);
 
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), 0);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(2 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    state.BindVertexArray(0);
+    state.BindBuffer(GL_ARRAY_BUFFER, 0);
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 void DsaBuffersCanvas::DestroyBuffers()
 {
-    if (vao_) {
-        glDeleteBuffers(1, &ebo_);
-        ebo_ = 0;
-        glDeleteBuffers(1, &vbo_);
-        vbo_ = 0;
-        glDeleteBuffers(1, &vao_);
-        vao_ = 0;
-    }
+    // deleted once the frames that drew with them have finished
+    vao_.Reset();
+    ebo_.Reset();
+    vbo_.Reset();
 }
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "canvas.h"
+#include "gl/shader_library.h"
 #include "utils.h"
 
 #include <array>
@@ -32,10 +33,10 @@ private:
     void DestroyBuffers();
 
 private:
-    GLuint shader_ = 0;
-    GLuint vao_ = 0;
-    GLuint vbo_ = 0;
-    GLuint ebo_ = 0;
+    GL::ShaderProgram* shader_ = nullptr; // owned by the shader library
+    GL::VertexArray vao_;
+    GL::Buffer      vbo_;
+    GL::Buffer      ebo_;
 
     bool useDsa_ = true;
 
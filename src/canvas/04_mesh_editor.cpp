@@ -11,6 +11,8 @@
 
 MeshEditorCanvas::MeshEditorCanvas() 
 {
+    SetUpdatePolicy(UpdatePolicy::Static);
+    SetBuildUIThreadSafe(true);
     bgColor_ = Color::Convert(0xB0BEC5ff);
     modes_ = {
         new SelectionMode,
@@ -55,11 +57,14 @@ void MeshEditorCanvas::BuildUI()
     modes_[activeMode_]->OnMouseClick(m, io.MouseClicked);
 }
 
-void MeshEditorCanvas::Render()
+void MeshEditorCanvas::Render() { RecordRender()(); }
+
+std::function<void()> MeshEditorCanvas::RecordRender()
 {
     const auto size = ImGui::GetMainViewport()->Size;
-    glViewport(0, 0, size.x, size.y);
-    glClearColor(bgColor_.r, bgColor_.g, bgColor_.b, bgColor_.a);
-    glClear(GL_COLOR_BUFFER_BIT);
-
+    return [size, bgColor = bgColor_]() {
+        GL::GetStateCache().Viewport(0, 0, size.x, size.y);
+        glClearColor(bgColor.r, bgColor.g, bgColor.b, bgColor.a);
+        glClear(GL_COLOR_BUFFER_BIT);
+    };
 }
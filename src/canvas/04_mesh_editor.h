@@ -25,6 +25,7 @@ public:
 
     void BuildUI() override;
     void Render() override;
+    std::function<void()> RecordRender() override;
 
 private:
 
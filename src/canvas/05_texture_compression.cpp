@@ -1,49 +1,23 @@
 #include "05_texture_compression.h"
+#include "app.h"
 #include "gl/framework.h"
 #include "utils.h"
 
 #include <imgui.h>
 #include <imgui_stdlib.h>
 #include <nfd.hpp>
+#include <spdlog/spdlog.h>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <format>
 
 
 TextureCompressionCanvas::TextureCompressionCanvas() 
 {
-    shader_ = GL::CreateShader(
-        R"(#version 460 core
-        out vec2 texcoord;
-        uniform mat4 proj;
-        void main()
-        {
-            vec2 points[4] = vec2[](
-                vec2(-1.0f, -1.0f),
-                vec2(-1.0f,  1.0f),
-                vec2( 1.0f,  1.0f),
-                vec2( 1.0f, -1.0f)
-            );
-            gl_Position = proj * vec4(points[gl_VertexID], 0.0, 1.0);
-            texcoord = (points[gl_VertexID] + 1.0) / 2;
-        })",
-        R"(#version 460 core
-        in vec2 texcoord;
-        out vec4 color;
-        uniform float edge;
-        uniform sampler2D tex0;
-        uniform sampler2D tex1;
-        void main()
-        {
-            float fragX = gl_FragCoord.x;
-            float c = step(edge, gl_FragCoord.x);
-            vec4 color0 = texture(tex0, texcoord);
-            vec4 color1 = texture(tex1, texcoord);
-            float inRange = step(edge - 0.5, fragX) * step(fragX, edge + 0.49);
-            color = mix(color0 * (1 - c) + color1 * c, vec4(0.0, 0.0, 0.0, 1.0), inRange);
-        })"
-    );
+    SetUpdatePolicy(UpdatePolicy::Static);
+    shader_ = App::GetShaderLibrary()->Load("texture_compression.vert", "texture_compression.frag");
 
     FetchSupportedCompressions();
     UpdateAllTextures();
@@ -51,7 +25,10 @@ TextureCompressionCanvas::TextureCompressionCanvas()
 
 TextureCompressionCanvas::~TextureCompressionCanvas() 
 {
-    glDeleteProgram(shader_);
+    auto* uploads = App::GetUploadService();
+    for (int i = 0; i < 2; ++i) {
+        uploads->Cancel(tickets_[i]);
+    }
 }
 
 void TextureCompressionCanvas::BuildUI()
@@ -90,8 +67,7 @@ void TextureCompressionCanvas::BuildUI()
             supportedCompressions_.data(), supportedCompressions_.size());
         if (value != compressions_[i]) {
             compressions_[i] = value;
-            DeleteTexture(textures_[i]);
-            textures_[i] = LoadTexture(imagePath_, supportedCompressions_[compressions_[i]]);
+            LoadTexture(i, imagePath_, supportedCompressions_[compressions_[i]]);
         }
     }
     ImGui::SliderFloat("edge", &edge_, 0.001f, 1.0f);
@@ -105,28 +81,44 @@ void TextureCompressionCanvas::Render()
     const auto aspect = size.x / size.y;
     proj_ = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f);
 
-    glViewport(250 + (size.x - imageSize_.x * zoom_) / 2,
-               (size.y - imageSize_.y * zoom_) / 2, imageSize_.x * zoom_,
-               imageSize_.y * zoom_);
+    auto& state = GL::GetStateCache();
+    state.Viewport(250 + (size.x - imageSize_.x * zoom_) / 2,
+                   (size.y - imageSize_.y * zoom_) / 2, imageSize_.x * zoom_,
+                   imageSize_.y * zoom_);
     glClearColor(bgColor_.r, bgColor_.g, bgColor_.b, bgColor_.a);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glUseProgram(shader_);
+    // only the background until the program is linked
+    const auto shader = shader_->Get();
+    if (!shader) {
+        return;
+    }
+
+    if (shaderVersion_ != shader_->GetVersion()) {
+        ResolveUniforms();
+    }
+
+    state.UseProgram(shader);
+    const auto placeholder = App::GetUploadService()->GetPlaceholderTexture();
     for (int i = 0; i < 2; ++i) {
-        glActiveTexture(GL_TEXTURE0 + i);
-        glBindTexture(GL_TEXTURE_2D, textures_[i]); 
-        const auto loc = glGetUniformLocation(shader_, std::format("tex{}", i).c_str());
-        glUniform1i(loc, i);
+        state.BindTexture(i, textures_[i] ? textures_[i].Get() : placeholder);
     }
 
-    glUniform1f(glGetUniformLocation(shader_, "edge"), 250 + (size.x - imageSize_.x * zoom_) / 2 + edge_ * imageSize_.x * zoom_);
-    glUniformMatrix4fv(glGetUniformLocation(shader_, "proj"), 1, GL_FALSE, glm::value_ptr(proj_));
+    edgeUniform_.Set(250 + (size.x - imageSize_.x * zoom_) / 2 + edge_ * imageSize_.x * zoom_);
+    projUniform_.Set(proj_);
 
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+}
 
-    glUseProgram(0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+void TextureCompressionCanvas::ResolveUniforms()
+{
+    const auto& reflection = shader_->GetReflection();
+    // samplers read fixed units, set once per program
+    reflection.GetUniform<GL::TextureUnit>(Tex0).Set({0});
+    reflection.GetUniform<GL::TextureUnit>(Tex1).Set({1});
+    edgeUniform_ = reflection.GetUniform<float>(Edge);
+    projUniform_ = reflection.GetUniform<glm::mat4>(Proj);
+    shaderVersion_ = shader_->GetVersion();
 }
 
 void TextureCompressionCanvas::FetchSupportedCompressions()
@@ -150,71 +142,48 @@ void TextureCompressionCanvas::FetchSupportedCompressions()
     }
 }
 
-GLuint TextureCompressionCanvas::LoadTexture(const std::string& path, GLenum compression)
+void TextureCompressionCanvas::LoadTexture(int slot, const std::string& path,
+                                           GLenum compression)
 {
-    // Generate a texture ID
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); // Wrap mode for S axis
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT); // Wrap mode for T axis
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // Minification filter
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Magnification filter
-
-    // Load the image using STB Image
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true); // Flip the image vertically (OpenGL expects 0,0 at the bottom-left)
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-
-    if (data) {
-        // Determine the format based on the number of channels
-        GLenum format = GL_RGB;
-        if (nrChannels == 1)
-            format = GL_RED;
-        else if (nrChannels == 3)
-            format = GL_RGB;
-        else if (nrChannels == 4)
-            format = GL_RGBA;
-
-        // Upload the image data to the GPU
-        glTexImage2D(GL_TEXTURE_2D, 0,
-                     compression == GL_NONE ? format : compression, width,
-                     height, 0, format, GL_UNSIGNED_BYTE, data);
-        GLuint size = width * height * 4;
-        GLint compressedSize = 0;
-        GL_CALL(glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressedSize));
-        SPDLOG_DEBUG(
-            "loaded texture {}x{}, compression={} size={} compressed={}", width,
-            height, GetCompressionName(compression), size, compressedSize);
-        // glGenerateMipmap(GL_TEXTURE_2D); // Generate mipmaps
-        imageSize_ = ImVec2{(float)width, (float)height};
-    } else {
-        SPDLOG_ERROR("Failed to load texture: {}", path);
-        imageSize_ = ImVec2{0.0f, 0.0f};
-    }
-
-    // Free the image data
-    stbi_image_free(data);
+    // decoding and compressing a large image takes far longer than a frame,
+    // the previous texture of the slot is dropped right away so the
+    // placeholder shows which side is still loading
+    auto* uploads = App::GetUploadService();
+    uploads->Cancel(tickets_[slot]);
+    textures_[slot].Reset();
 
-    return textureID;
+    GL::UploadService::TextureRequest request;
+    request.path = path;
+    request.internalFormat = compression;
+    tickets_[slot] = uploads->LoadTexture(
+        std::move(request),
+        [this, slot, compression](const GL::UploadService::TextureResult& res) {
+            tickets_[slot] = 0;
+            RequestRedraw();
+            if (!res.texture) {
+                imageSize_ = ImVec2{0.0f, 0.0f};
+                return;
+            }
+            SPDLOG_DEBUG(
+                "loaded texture {}x{}, compression={} size={} compressed={}",
+                res.width, res.height, GetCompressionName(compression),
+                res.width * res.height * 4, res.compressedSize);
+            const auto bytes = res.compressedSize
+                ? res.compressedSize
+                : (int64_t)res.width * res.height * 4;
+            textures_[slot] = GL::Texture(res.texture, this, bytes);
+            imageSize_ = ImVec2{(float)res.width, (float)res.height};
+        });
 }
 
 void TextureCompressionCanvas::UpdateAllTextures()
 {
     for (int i = 0; i < 2; ++i) {
         compressions_[i] = 0;
-        DeleteTexture(textures_[i]);
-        textures_[i] = LoadTexture(imagePath_, supportedCompressions_[compressions_[i]]);
+        LoadTexture(i, imagePath_, supportedCompressions_[compressions_[i]]);
     }
 }
 
-void TextureCompressionCanvas::DeleteTexture(GLuint texture)
-{
-    glDeleteTextures(1, &texture);
-}
-
 const std::string& TextureCompressionCanvas::GetCompressionName(GLenum id)
 {
     #define element(x) {x, std::format("{:x} "#x, x)}
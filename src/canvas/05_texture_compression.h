@@ -1,6 +1,8 @@
 #pragma once
 
 #include "canvas.h"
+#include "gl/shader_library.h"
+#include "gl/upload_service.h"
 #include "utils.h"
 
 #include <glad/glad.h>
@@ -18,19 +20,30 @@ public:
 
 private:
     void FetchSupportedCompressions();
-    GLuint LoadTexture(const std::string& path, GLenum compression = GL_NONE);
+    // Shows the placeholder in the slot until the upload service is done.
+    void LoadTexture(int slot, const std::string& path,
+                     GLenum compression = GL_NONE);
 
-    void DeleteTexture(GLuint texture);
     void UpdateAllTextures();
+    // Looks the uniforms up in the reflection of the current program.
+    void ResolveUniforms();
     static const std::string& GetCompressionName(GLenum compression);
 
 private:
+    static constexpr auto Tex0 = GL::HashName("tex0");
+    static constexpr auto Tex1 = GL::HashName("tex1");
+    static constexpr auto Edge = GL::HashName("edge");
+    static constexpr auto Proj = GL::HashName("proj");
 
     std::string imagePath_ = "./assets/Lenna_512x512.png";
-    ImVec2 imageSize_ = {};
+    ImVec2 imageSize_ = {512.0f, 512.0f};
     std::vector<GLenum> supportedCompressions_;
-    GLuint shader_;
-    std::array<GLuint, 2> textures_ = {0, 0};
+    GL::ShaderProgram* shader_ = nullptr; // owned by the shader library
+    uint64_t shaderVersion_ = 0; // of the resolved uniforms
+    GL::Uniform<float> edgeUniform_;
+    GL::Uniform<glm::mat4> projUniform_;
+    std::array<GL::Texture, 2> textures_; // empty - the placeholder
+    std::array<GL::UploadService::Ticket, 2> tickets_ = {0, 0};
     std::array<uint32_t, 2> compressions_ = {0, 0};
     Color bgColor_ = Utils::GetNextColorFromPalette();
     glm::mat4 proj_;
@@ -1,8 +1,25 @@
 #pragma once
 
+#include "gl/validation.h"
+
+#include <atomic>
+#include <functional>
+
 class Canvas
 {
 public:
+    // Animated canvases are rebuilt and rendered on every frame of their
+    // window. Static ones only when something invalidated them: input to
+    // their window, a resize, a display change or RequestRedraw().
+    enum class UpdatePolicy
+    {
+        Animated,
+        Static,
+    };
+
+    // ImGui needs a few frames after input to settle hover and focus state.
+    static constexpr int InputRedrawFrames = 3;
+
     Canvas() {};
     virtual ~Canvas() {};
     Canvas(const Canvas&) = delete;
@@ -12,4 +29,67 @@ public:
     
     virtual void BuildUI() = 0;
     virtual void Render() = 0;
+
+    // Render thread support: returns this frame's GL work as a closure that
+    // runs later on the render thread while the next frame's UI is being
+    // built, so it has to capture what it needs by value (ImGui state
+    // included) instead of reading members that BuildUI() changes.
+    // Canvases that return nothing are rendered with Render() on the main
+    // thread, which then takes the GL context back for that frame.
+    virtual std::function<void()> RecordRender() { return {}; }
+
+    UpdatePolicy GetUpdatePolicy() const { return updatePolicy_; }
+    void         SetUpdatePolicy(UpdatePolicy policy)
+    {
+        updatePolicy_ = policy;
+        RequestRedraw();
+    }
+
+    // BuildUI() may run on a worker thread, concurrently with other windows,
+    // when it only touches ImGui and the canvas's own state: no GL, SDL or
+    // App calls and no state shared between canvases.
+    bool IsBuildUIThreadSafe() const { return buildUIThreadSafe_; }
+    void SetBuildUIThreadSafe(bool threadSafe)
+    {
+        buildUIThreadSafe_ = threadSafe;
+    }
+
+    // GL validation while the canvas renders. Raises the app's tier
+    // (--gl-validation) for this canvas only, never lowers it.
+    GL::Validation GetGLValidation() const { return glValidation_; }
+    void           SetGLValidation(GL::Validation validation)
+    {
+        glValidation_ = validation;
+    }
+
+    // Keeps the canvas updating for at least the given number of frames.
+    // Safe to call from any thread.
+    void RequestRedraw(int frames = 1)
+    {
+        auto current = redrawFrames_.load(std::memory_order_relaxed);
+        while (current < frames
+               && !redrawFrames_.compare_exchange_weak(current, frames)) {
+        }
+    }
+
+    bool NeedsRedraw() const
+    {
+        return updatePolicy_ == UpdatePolicy::Animated
+            || redrawFrames_.load(std::memory_order_relaxed) > 0;
+    }
+
+    // Called by the app after every frame of the canvas.
+    void OnFrameDrawn()
+    {
+        auto current = redrawFrames_.load(std::memory_order_relaxed);
+        while (current > 0
+               && !redrawFrames_.compare_exchange_weak(current, current - 1)) {
+        }
+    }
+
+private:
+    UpdatePolicy     updatePolicy_ = UpdatePolicy::Animated;
+    std::atomic<int> redrawFrames_ = InputRedrawFrames;
+    bool             buildUIThreadSafe_ = false;
+    GL::Validation   glValidation_ = GL::Validation::Off;
 };
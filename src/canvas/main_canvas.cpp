@@ -4,12 +4,20 @@
 #include "canvas/03_dsa_buffers.h"
 #include "canvas/04_mesh_editor.h"
 #include "canvas/05_texture_compression.h"
+#include "gl/framework.h"
 #include "main_canvas.h"
 
 #include <glad/glad.h>
 #include <imgui.h>
 
-MainCanvas::MainCanvas() { FillExamplesVector(); }
+#include <cctype>
+#include <charconv>
+
+MainCanvas::MainCanvas()
+{
+    SetUpdatePolicy(UpdatePolicy::Static);
+    FillExamplesVector(examples_);
+}
 
 MainCanvas::~MainCanvas() { }
 
@@ -23,11 +31,12 @@ void MainCanvas::BuildUI()
     ImGui::SetNextWindowPos(ImGui::GetMainViewport()->Pos);
     ImGui::SetNextWindowSize(ImGui::GetMainViewport()->Size);
     ImGui::Begin("Main Canvas", nullptr, windowFlags);
-    ImGui::BeginTable("Examples##table", 3, tableFlags);
+    ImGui::BeginTable("Examples##table", 4, tableFlags);
     ImGui::TableSetupColumn(
         "№", ImGuiTableColumnFlags_NoResize);
     ImGui::TableSetupColumn("Title", ImGuiTableColumnFlags_WidthStretch);
     ImGui::TableSetupColumn("Open", ImGuiTableColumnFlags_NoResize);
+    ImGui::TableSetupColumn("GL validation", ImGuiTableColumnFlags_NoResize);
     for (size_t i = 0; i < examples_.size(); ++i) {
         TableRow(i);
     }
@@ -38,7 +47,7 @@ void MainCanvas::BuildUI()
 void MainCanvas::Render()
 {
     const auto size = ImGui::GetMainViewport()->Size;
-    glViewport(0, 0, size.x, size.y);
+    GL::GetStateCache().Viewport(0, 0, size.x, size.y);
 
     
     auto color = ImGui::GetStyle().Colors[ImGuiCol_WindowBg];
@@ -46,18 +55,62 @@ void MainCanvas::Render()
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
-void MainCanvas::FillExamplesVector()
+static std::string NormalizeExampleName(std::string_view name)
 {
-    examples_.emplace_back("Hello triangle",
-                           []() -> Canvas* { return new HelloTriangleCanvas; });
-    examples_.emplace_back("Draw Commands",
-                           []() -> Canvas* { return new DrawCommandsCanvas; });
-    examples_.emplace_back("DSA buffers",
-                           []() -> Canvas* { return new DsaBuffersCanvas; });
-    examples_.emplace_back("Mesh editor",
-                           []() -> Canvas* { return new MeshEditorCanvas; });
-    examples_.emplace_back("Texture compression",
-                           []() -> Canvas* { return new TextureCompressionCanvas; });
+    std::string normalized;
+    for (auto c : name) {
+        if (c != ' ' && c != '_' && c != '-') {
+            normalized += (char)std::tolower((unsigned char)c);
+        }
+    }
+    return normalized;
+}
+
+Canvas* MainCanvas::CreateExample(std::string_view name)
+{
+    std::vector<Example> examples;
+    FillExamplesVector(examples);
+
+    size_t index = 0;
+    const auto* end = name.data() + name.size();
+    if (std::from_chars(name.data(), end, index).ptr == end) {
+        return index < examples.size() ? examples[index].initializer()
+                                       : nullptr;
+    }
+
+    const auto normalized = NormalizeExampleName(name);
+    for (auto& example : examples) {
+        if (NormalizeExampleName(example.title) == normalized) {
+            return example.initializer();
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::string> MainCanvas::GetExampleTitles()
+{
+    std::vector<Example> examples;
+    FillExamplesVector(examples);
+
+    std::vector<std::string> titles;
+    for (auto& example : examples) {
+        titles.push_back(example.title);
+    }
+    return titles;
+}
+
+void MainCanvas::FillExamplesVector(std::vector<Example>& examples)
+{
+    examples.emplace_back("Hello triangle",
+                          []() -> Canvas* { return new HelloTriangleCanvas; });
+    examples.emplace_back("Draw Commands",
+                          []() -> Canvas* { return new DrawCommandsCanvas; });
+    examples.emplace_back("DSA buffers",
+                          []() -> Canvas* { return new DsaBuffersCanvas; });
+    examples.emplace_back("Mesh editor",
+                          []() -> Canvas* { return new MeshEditorCanvas; });
+    examples.emplace_back("Texture compression",
+                          []() -> Canvas* { return new TextureCompressionCanvas; });
 }
 
 void MainCanvas::TableRow(size_t i)
@@ -87,5 +140,25 @@ void MainCanvas::TableRow(size_t i)
             App::OpenWindow(example.canvas);
         }
     }
+
+    // raises --gl-validation for this canvas, "off" follows the app's tier
+    ImGui::TableNextColumn();
+    if (example.canvas) {
+        static constexpr GL::Validation validations[] = {
+            GL::Validation::Off, GL::Validation::Async, GL::Validation::Sync,
+            GL::Validation::Full};
+        const auto current = example.canvas->GetGLValidation();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6);
+        if (ImGui::BeginCombo("##validation", GL::ToString(current))) {
+            for (const auto validation : validations) {
+                if (ImGui::Selectable(GL::ToString(validation),
+                                      validation == current)) {
+                    example.canvas->SetGLValidation(validation);
+                    example.canvas->RequestRedraw();
+                }
+            }
+            ImGui::EndCombo();
+        }
+    }
     ImGui::PopID();
 }
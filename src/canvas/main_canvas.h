@@ -2,6 +2,7 @@
 
 #include "canvas.h"
 #include <string>
+#include <string_view>
 #include <vector>
 
 class MainCanvas : public Canvas
@@ -13,9 +14,10 @@ public:
     void BuildUI() override;
     void Render() override;
 
-private:
-    void FillExamplesVector();
-    void TableRow(size_t i);
+    // Creates an example by its title (case, spaces, '_' and '-' are
+    // ignored) or by its index in the table, nullptr if there is none.
+    static Canvas*                  CreateExample(std::string_view name);
+    static std::vector<std::string> GetExampleTitles();
 
 private:
     using Initializer = Canvas*(*)();
@@ -28,7 +30,13 @@ private:
         Initializer initializer;
         Canvas* canvas = nullptr;
     };
+
+private:
+    static void FillExamplesVector(std::vector<Example>& examples);
+    void TableRow(size_t i);
+
+private:
     std::vector<Example> examples_;
 
     
-};
\ No newline at end of file
+};
@@ -0,0 +1,126 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+
+static constexpr uint64_t g_nsPerSecond = 1'000'000'000;
+
+void FramePacer::SetMode(Mode mode)
+{
+    if (mode_ != mode) {
+        mode_ = mode;
+        Restart();
+    }
+}
+
+void FramePacer::SetTargetRate(double hz)
+{
+    targetRate_ = hz > 0.0 ? hz : DefaultRate;
+    Restart();
+}
+
+void FramePacer::SetDisplayRate(double hz)
+{
+    hz = hz > 0.0 ? hz : DefaultRate;
+    if (displayRate_ != hz) {
+        displayRate_ = hz;
+        Restart();
+    }
+}
+
+double FramePacer::GetRate() const
+{
+    switch (mode_) {
+    case Mode::Display:
+        return displayRate_;
+    case Mode::Fixed:
+        return targetRate_;
+    default:
+        return 0.0;
+    }
+}
+
+int FramePacer::GetSwapInterval() const
+{
+    switch (mode_) {
+    case Mode::Display:
+    case Mode::VSync:
+        return 1;
+    case Mode::Fixed:
+        // vsync would cap us below the requested rate
+        return targetRate_ <= displayRate_ ? 1 : 0;
+    default:
+        return 0;
+    }
+}
+
+uint64_t FramePacer::GetPeriod() const
+{
+    const auto rate = GetRate();
+    return rate > 0.0 ? (uint64_t)((double)g_nsPerSecond / rate) : 0;
+}
+
+uint64_t FramePacer::GetDeadline() const
+{
+    return GetPeriod() ? deadline_ : 0;
+}
+
+bool FramePacer::IsDue(uint64_t nowNs) const
+{
+    return !GetPeriod() || nowNs >= deadline_;
+}
+
+void FramePacer::OnFrame(uint64_t nowNs)
+{
+    const auto period = GetPeriod();
+    ++stats_.frames;
+
+    if (!period) {
+        // Not deadline driven: a frame is late when it took noticeably
+        // longer than a display refresh.
+        const auto refresh = (uint64_t)((double)g_nsPerSecond / displayRate_);
+        if (lastFrame_ && nowNs - lastFrame_ > refresh + refresh / 2) {
+            const auto lateness = nowNs - lastFrame_ - refresh;
+            ++stats_.lateFrames;
+            stats_.missed += (nowNs - lastFrame_) / refresh - 1;
+            stats_.totalLatenessNs += lateness;
+            stats_.worstLatenessNs = std::max(stats_.worstLatenessNs, lateness);
+        }
+        lastFrame_ = nowNs;
+        return;
+    }
+
+    if (!deadline_) {
+        deadline_ = nowNs + period;
+        lastFrame_ = nowNs;
+        return;
+    }
+
+    const auto lateness = nowNs > deadline_ ? nowNs - deadline_ : 0;
+    if (lateness > period / 2) {
+        ++stats_.lateFrames;
+    }
+    stats_.totalLatenessNs += lateness;
+    stats_.worstLatenessNs = std::max(stats_.worstLatenessNs, lateness);
+
+    // Stay on the original timeline: skip the periods we have missed
+    // instead of rendering them back to back.
+    const auto skipped = lateness / period;
+    stats_.missed += skipped;
+    deadline_ += (skipped + 1) * period;
+    lastFrame_ = nowNs;
+}
+
+const char* ToString(FramePacer::Mode mode)
+{
+    switch (mode) {
+    case FramePacer::Mode::Display:
+        return "display";
+    case FramePacer::Mode::Fixed:
+        return "fixed";
+    case FramePacer::Mode::VSync:
+        return "vsync";
+    case FramePacer::Mode::Uncapped:
+        return "uncapped";
+    }
+    return "unknown";
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+// Schedules frames of a single window on an absolute nanosecond timeline
+// (SDL_GetTicksNS). Deadlines advance by a whole period every frame, so
+// the cadence does not drift when a frame starts a little late, and
+// skipped periods are counted as missed instead of being caught up.
+class FramePacer
+{
+public:
+    enum class Mode
+    {
+        Display,  // follow the refresh rate of the window's display
+        Fixed,    // follow the target rate set by SetTargetRate()
+        VSync,    // render every iteration, swap interval paces the frames
+        Uncapped, // render every iteration, no swap interval
+    };
+
+    struct Stats
+    {
+        uint64_t frames = 0;
+        uint64_t missed = 0; // periods that passed without a frame
+        uint64_t lateFrames = 0; // frames started more than half a period late
+        uint64_t worstLatenessNs = 0;
+        uint64_t totalLatenessNs = 0;
+    };
+
+    static constexpr double DefaultRate = 60.0;
+
+    void   SetMode(Mode mode);
+    Mode   GetMode() const { return mode_; }
+    void   SetTargetRate(double hz);
+    double GetTargetRate() const { return targetRate_; }
+    void   SetDisplayRate(double hz);
+    double GetDisplayRate() const { return displayRate_; }
+
+    // Effective rate in Hz, 0 for modes that are not deadline driven.
+    double GetRate() const;
+    int    GetSwapInterval() const;
+
+    // Deadline of the next frame, 0 when the pacer wants a frame on every
+    // loop iteration (VSync/Uncapped).
+    uint64_t GetDeadline() const;
+    bool     IsDue(uint64_t nowNs) const;
+    void     OnFrame(uint64_t nowNs);
+    // The window stopped rendering (nothing to redraw), the next OnFrame()
+    // re-anchors the timeline without counting the idle time as missed.
+    void Suspend()
+    {
+        deadline_ = 0;
+        lastFrame_ = 0;
+    }
+
+    void         ResetStats() { stats_ = {}; }
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    uint64_t GetPeriod() const;
+    void     Restart() { deadline_ = 0; }
+
+private:
+    Mode     mode_ = Mode::Display;
+    double   targetRate_ = DefaultRate;
+    double   displayRate_ = DefaultRate;
+    uint64_t deadline_ = 0; // 0 - render as soon as possible and re-anchor
+    uint64_t lastFrame_ = 0;
+    Stats    stats_;
+};
+
+const char* ToString(FramePacer::Mode mode);
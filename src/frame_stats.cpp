@@ -0,0 +1,100 @@
+#include "frame_stats.h"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+
+const char* ToString(FrameStage stage)
+{
+    switch (stage) {
+    case FrameStage::NewFrame:
+        return "new frame";
+    case FrameStage::BuildUI:
+        return "build ui";
+    case FrameStage::Render:
+        return "render";
+    case FrameStage::RenderUI:
+        return "render ui";
+    case FrameStage::Swap:
+        return "swap";
+    case FrameStage::Total:
+        return "total";
+    case FrameStage::GpuRender:
+        return "gpu render";
+    case FrameStage::GpuRenderUI:
+        return "gpu render ui";
+    case FrameStage::FenceWait:
+        return "fence wait";
+    default:
+        return "unknown";
+    }
+}
+
+void FrameStats::Record(FrameStage stage, uint64_t ns)
+{
+    auto&      ring = rings_[(size_t)stage];
+    const auto head = ring.head.load(std::memory_order_relaxed);
+    ring.samples[head & (Capacity - 1)].store(ns, std::memory_order_relaxed);
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+FrameStats::Summary FrameStats::Summarize(FrameStage stage) const
+{
+    const auto& ring = rings_[(size_t)stage];
+    const auto  head = ring.head.load(std::memory_order_acquire);
+    const auto  count = (size_t)std::min<uint64_t>(head, Capacity);
+
+    std::array<uint64_t, Capacity> sorted;
+    for (size_t i = 0; i < count; ++i) {
+        sorted[i] = ring.samples[i].load(std::memory_order_relaxed);
+    }
+    std::sort(sorted.begin(), sorted.begin() + count);
+
+    Summary summary;
+    summary.count = count;
+    if (count == 0) {
+        return summary;
+    }
+    auto percentile = [&](double p) {
+        const auto rank = (size_t)(p * (double)(count - 1) + 0.5);
+        return sorted[rank] / 1e6;
+    };
+    summary.p50 = percentile(0.50);
+    summary.p95 = percentile(0.95);
+    summary.p99 = percentile(0.99);
+    summary.max = sorted[count - 1] / 1e6;
+    return summary;
+}
+
+uint64_t FrameStats::GetCount(FrameStage stage) const
+{
+    return rings_[(size_t)stage].head.load(std::memory_order_acquire);
+}
+
+uint64_t FrameStats::GetSample(FrameStage stage, uint64_t index) const
+{
+    return rings_[(size_t)stage].samples[index & (Capacity - 1)].load(
+        std::memory_order_relaxed);
+}
+
+void FrameStats::Reset()
+{
+    for (auto& ring : rings_) {
+        ring.head.store(0, std::memory_order_release);
+    }
+}
+
+StageTimer::StageTimer(FrameStats& stats, FrameStage stage)
+    : stats_(&stats)
+    , stage_(stage)
+    , start_(SDL_GetTicksNS())
+{
+}
+
+void StageTimer::Stop()
+{
+    if (stats_) {
+        stats_->Record(stage_, SDL_GetTicksNS() - start_);
+        stats_ = nullptr;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum class FrameStage
+{
+    NewFrame, // ImGui backends + ImGui::NewFrame
+    BuildUI,  // Canvas::BuildUI + ImGui::Render
+    Render,   // Canvas::Render
+    RenderUI, // ImGuiGLRenderDrawData
+    Swap,     // SDL_GL_SwapWindow
+    Total,
+    GpuRender,   // GPU time of Canvas::Render, a few frames behind
+    GpuRenderUI, // GPU time of ImGuiGLRenderDrawData, a few frames behind
+    FenceWait,   // CPU blocked on the frames-in-flight limit
+    Count
+};
+
+const char* ToString(FrameStage stage);
+
+// Per-window frame timings. Every stage keeps the last Capacity samples in
+// a fixed-size ring; one thread records, any thread may summarize. Readers
+// never block the writer, they can only observe a sample that is being
+// overwritten, which is fine for statistics.
+class FrameStats
+{
+public:
+    static constexpr size_t Capacity = 256;
+    static_assert((Capacity & (Capacity - 1)) == 0, "must be a power of two");
+
+    struct Summary
+    {
+        size_t count = 0;
+        double p50 = 0.0; // milliseconds
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    void    Record(FrameStage stage, uint64_t ns);
+    Summary Summarize(FrameStage stage) const;
+    void    Reset();
+
+    // Raw access for consumers that keep their own history: samples with
+    // index in [GetCount() - Capacity, GetCount()) are still in the ring.
+    uint64_t GetCount(FrameStage stage) const;
+    uint64_t GetSample(FrameStage stage, uint64_t index) const;
+
+private:
+    struct Ring
+    {
+        std::array<std::atomic<uint64_t>, Capacity> samples = {};
+        std::atomic<uint64_t>                        head = 0;
+    };
+    std::array<Ring, (size_t)FrameStage::Count> rings_;
+};
+
+// Measures the time between construction and Stop() or destruction.
+class StageTimer
+{
+public:
+    StageTimer(FrameStats& stats, FrameStage stage);
+    ~StageTimer() { Stop(); }
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    void Stop();
+
+private:
+    FrameStats* stats_;
+    FrameStage  stage_;
+    uint64_t    start_;
+};
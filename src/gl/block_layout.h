@@ -0,0 +1,116 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace GL {
+
+// Memory layouts of interface blocks, see "Standard Uniform Block Layout" of
+// the GL spec. std430 is std140 without rounding arrays and structs up to 16
+// bytes, it is only available for shader storage blocks.
+enum class BlockLayout
+{
+    Std140,
+    Std430
+};
+
+namespace Detail {
+constexpr size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Base alignment and size of a C++ type that mirrors a GLSL one. Types
+// without a specialization have no GLSL counterpart of the same size
+// (bool, glm::mat3, ...) and don't compile.
+template <BlockLayout Layout, typename T>
+struct LayoutType;
+
+#define DEFINE_LAYOUT_TYPE(_TYPE, _ALIGN)                                     \
+    template <BlockLayout Layout>                                             \
+    struct LayoutType<Layout, _TYPE>                                          \
+    {                                                                         \
+        static constexpr size_t Alignment = _ALIGN;                           \
+        static constexpr size_t Size = sizeof(_TYPE);                         \
+    }
+
+DEFINE_LAYOUT_TYPE(float, 4);
+DEFINE_LAYOUT_TYPE(int32_t, 4);
+DEFINE_LAYOUT_TYPE(uint32_t, 4);
+DEFINE_LAYOUT_TYPE(glm::vec2, 8);
+DEFINE_LAYOUT_TYPE(glm::ivec2, 8);
+DEFINE_LAYOUT_TYPE(glm::uvec2, 8);
+DEFINE_LAYOUT_TYPE(glm::vec3, 16); // but 12 bytes, a scalar may follow
+DEFINE_LAYOUT_TYPE(glm::vec4, 16);
+DEFINE_LAYOUT_TYPE(glm::ivec4, 16);
+DEFINE_LAYOUT_TYPE(glm::uvec4, 16);
+DEFINE_LAYOUT_TYPE(glm::mat4, 16); // four vec4 columns
+#undef DEFINE_LAYOUT_TYPE
+
+// Arrays: elements are padded to their alignment, in std140 both are also
+// rounded up to a vec4.
+template <BlockLayout Layout, typename T, size_t N>
+struct LayoutType<Layout, std::array<T, N>>
+{
+    static constexpr size_t Alignment = Layout == BlockLayout::Std140
+        ? AlignUp(LayoutType<Layout, T>::Alignment, 16)
+        : LayoutType<Layout, T>::Alignment;
+    static constexpr size_t Stride
+        = AlignUp(LayoutType<Layout, T>::Size, Alignment);
+    static constexpr size_t Size = Stride * N;
+};
+
+template <BlockLayout Layout, typename T, size_t N>
+struct LayoutType<Layout, T[N]> : LayoutType<Layout, std::array<T, N>>
+{
+};
+
+template <typename T>
+struct LayoutMember
+{
+    using Type = T;
+    size_t offset;
+};
+
+template <typename T>
+constexpr LayoutMember<T> MakeLayoutMember(size_t offset)
+{
+    return {offset};
+}
+} // namespace Detail
+
+// A member of a block struct for CheckLayout().
+#define GL_LAYOUT_MEMBER(_STRUCT, _MEMBER)                                    \
+    GL::Detail::MakeLayoutMember<decltype(_STRUCT::_MEMBER)>(                 \
+        offsetof(_STRUCT, _MEMBER))
+
+// True if the members, given in declaration order, sit where the GLSL
+// block of the same members expects them, and arrays of the struct have the
+// block's stride. Meant for static_assert next to the struct:
+//
+//   struct Light { glm::vec3 position; float radius; };
+//   static_assert(GL::CheckLayout<GL::BlockLayout::Std140, Light>(
+//       GL_LAYOUT_MEMBER(Light, position), GL_LAYOUT_MEMBER(Light, radius)));
+//
+// A mismatch is fixed with explicit padding or alignas() in the struct.
+template <BlockLayout Layout, typename Struct, typename... Members>
+constexpr bool CheckLayout(Members... members)
+{
+    size_t offset = 0;
+    size_t alignment = Layout == BlockLayout::Std140 ? 16 : 1;
+    bool   ok = true;
+    const auto check = [&]<typename Member>(const Member& member) {
+        using Type = Detail::LayoutType<Layout, typename Member::Type>;
+        offset = Detail::AlignUp(offset, Type::Alignment);
+        ok = ok && member.offset == offset;
+        offset += Type::Size;
+        alignment = alignment > Type::Alignment ? alignment : Type::Alignment;
+    };
+    (check(members), ...);
+    return ok && sizeof(Struct) == Detail::AlignUp(offset, alignment);
+}
+
+} // namespace GL
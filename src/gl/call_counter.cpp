@@ -0,0 +1,168 @@
+#include "call_counter.h"
+
+#include <glad/glad.h>
+
+#include <atomic>
+
+// clang-format off
+#define GL_COUNTED_CALLS(X)                                                    \
+    X(DrawArrays, Draw)                                                        \
+    X(DrawElements, Draw)                                                      \
+    X(DrawElementsBaseVertex, Draw)                                            \
+    X(DrawArraysInstanced, Draw)                                               \
+    X(DrawElementsInstanced, Draw)                                             \
+    X(DrawElementsInstancedBaseVertex, Draw)                                   \
+    X(MultiDrawArrays, Draw)                                                   \
+    X(MultiDrawElements, Draw)                                                 \
+    X(MultiDrawElementsBaseVertex, Draw)                                       \
+    X(MultiDrawArraysIndirect, Draw)                                           \
+    X(MultiDrawElementsIndirect, Draw)                                         \
+    X(Clear, Draw)                                                             \
+    X(UseProgram, State)                                                       \
+    X(BindVertexArray, State)                                                  \
+    X(BindBuffer, State)                                                       \
+    X(BindBufferBase, State)                                                   \
+    X(BindBufferRange, State)                                                  \
+    X(BindTexture, State)                                                      \
+    X(BindTextureUnit, State)                                                  \
+    X(ActiveTexture, State)                                                    \
+    X(BindSampler, State)                                                      \
+    X(BindFramebuffer, State)                                                  \
+    X(Enable, State)                                                           \
+    X(Disable, State)                                                          \
+    X(BlendEquation, State)                                                    \
+    X(BlendEquationSeparate, State)                                            \
+    X(BlendFuncSeparate, State)                                                \
+    X(Viewport, State)                                                         \
+    X(Scissor, State)                                                          \
+    X(PolygonMode, State)                                                      \
+    X(Uniform1i, Uniform)                                                      \
+    X(Uniform1f, Uniform)                                                      \
+    X(Uniform4fv, Uniform)                                                     \
+    X(UniformMatrix4fv, Uniform)                                               \
+    X(ProgramUniform1i, Uniform)                                               \
+    X(ProgramUniform1f, Uniform)                                               \
+    X(ProgramUniformMatrix4fv, Uniform)                                        \
+    X(BufferData, Upload)                                                      \
+    X(BufferSubData, Upload)                                                   \
+    X(NamedBufferData, Upload)                                                 \
+    X(NamedBufferSubData, Upload)                                              \
+    X(TexImage2D, Upload)                                                      \
+    X(TexSubImage2D, Upload)                                                   \
+    X(TextureSubImage2D, Upload)                                               \
+    X(GetIntegerv, Query)                                                      \
+    X(IsEnabled, Query)                                                        \
+    X(GetError, Query)                                                         \
+    X(GetUniformLocation, Query)                                               \
+    X(GetAttribLocation, Query)                                                \
+    X(IsProgram, Query)
+// clang-format on
+
+namespace {
+
+enum CallId
+{
+#define X(name, category) CallId##name,
+    GL_COUNTED_CALLS(X)
+#undef X
+        CallIdCount
+};
+
+struct CallInfo
+{
+    const char*      name;
+    GL::CallCategory category;
+};
+
+constexpr CallInfo g_calls[] = {
+#define X(name, category) { "gl" #name, GL::CallCategory::category },
+    GL_COUNTED_CALLS(X)
+#undef X
+};
+
+std::atomic<uint64_t> g_counts[CallIdCount] = {};
+bool                  g_installed = false;
+
+template <size_t Id, typename Fn> struct Trampoline;
+
+template <size_t Id, typename R, typename... Args>
+struct Trampoline<Id, R(APIENTRY*)(Args...)>
+{
+    using Fn = R(APIENTRY*)(Args...);
+    static inline Fn original = nullptr;
+
+    static R APIENTRY Call(Args... args)
+    {
+        g_counts[Id].fetch_add(1, std::memory_order_relaxed);
+        return original(args...);
+    }
+
+    static void Install(Fn& pointer)
+    {
+        if (pointer) {
+            original = pointer;
+            pointer = &Call;
+        }
+    }
+};
+
+} // namespace
+
+const char* GL::ToString(CallCategory category)
+{
+    switch (category) {
+    case CallCategory::Draw:
+        return "draw";
+    case CallCategory::State:
+        return "state";
+    case CallCategory::Uniform:
+        return "uniform";
+    case CallCategory::Upload:
+        return "upload";
+    case CallCategory::Query:
+        return "query";
+    default:
+        return "unknown";
+    }
+}
+
+void GL::InstallCallCounters()
+{
+    if (g_installed) {
+        return;
+    }
+#define X(name, category)                                                      \
+    Trampoline<CallId##name, decltype(glad_gl##name)>::Install(glad_gl##name);
+    GL_COUNTED_CALLS(X)
+#undef X
+    g_installed = true;
+}
+
+bool GL::AreCallCountersInstalled() { return g_installed; }
+
+void GL::ResetCallCounters()
+{
+    for (auto& count : g_counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t GL::GetCallCount(CallCategory category)
+{
+    uint64_t total = 0;
+    for (size_t i = 0; i < CallIdCount; ++i) {
+        if (g_calls[i].category == category) {
+            total += g_counts[i].load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+void GL::ForEachCallCount(
+    const std::function<void(const char* name, CallCategory, uint64_t)>& fn)
+{
+    for (size_t i = 0; i < CallIdCount; ++i) {
+        fn(g_calls[i].name, g_calls[i].category,
+           g_counts[i].load(std::memory_order_relaxed));
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace GL {
+
+enum class CallCategory
+{
+    Draw,
+    State,
+    Uniform,
+    Upload,
+    Query,
+    Count
+};
+
+const char* ToString(CallCategory category);
+
+// Counts calls of a fixed set of GL entry points by swapping glad's function
+// pointers for counting trampolines. Costs one extra indirect call per
+// counted function, so it is only installed on request (benchmarks).
+// Must be called after gladLoadGLLoader.
+void InstallCallCounters();
+bool AreCallCountersInstalled();
+void ResetCallCounters();
+
+uint64_t GetCallCount(CallCategory category);
+void     ForEachCallCount(
+        const std::function<void(const char* name, CallCategory, uint64_t)>& fn);
+
+} // namespace GL
@@ -1,7 +1,16 @@
 #include "framework.h"
+#include "program_cache.h"
 
+#include <SDL3/SDL.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
 #include <cstdio>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 bool GL::CheckShader(GLuint handle, const char* desc)
 {
@@ -37,38 +46,696 @@ bool GL::CheckProgram(GLuint handle, const char* desc)
     return (GLboolean)status == GL_TRUE;
 }
 
-GLuint GL::CreateShader(const GLchar* vertexShader, const GLchar* fragmentShader)
+bool GL::EnableParallelShaderCompile()
+{
+    // 0xFFFFFFFF - as many threads as the driver wants
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        return true;
+    }
+    if (GLAD_GL_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        return true;
+    }
+    return false;
+}
+
+GL::PendingProgram::PendingProgram(const GLchar* vertexShader,
+                                   const GLchar* fragmentShader)
 {
-    bool ok = true;
+    auto* cache = GL::GetProgramCache();
+    if (cache) {
+        cacheKey_ = cache->MakeKey({ vertexShader, fragmentShader });
+        program_ = cache->Load(cacheKey_);
+        if (program_) {
+            state_ = State::Ready;
+            return;
+        }
+    }
+
+    // no status queries here, they would wait for the compile
+    const auto start = SDL_GetTicksNS();
+    GL_CALL(vertHandle_ = glCreateShader(GL_VERTEX_SHADER));
+    glShaderSource(vertHandle_, 1, &vertexShader, nullptr);
+    glCompileShader(vertHandle_);
+
+    GL_CALL(fragHandle_ = glCreateShader(GL_FRAGMENT_SHADER));
+    glShaderSource(fragHandle_, 1, &fragmentShader, nullptr);
+    glCompileShader(fragHandle_);
+
+    program_ = glCreateProgram();
+    if (cache) {
+        glProgramParameteri(program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                            GL_TRUE);
+    }
+    glAttachShader(program_, vertHandle_);
+    glAttachShader(program_, fragHandle_);
+    glLinkProgram(program_);
+    state_ = State::Compiling;
+    buildNs_ = SDL_GetTicksNS() - start;
+}
 
-    GLuint vertHandle;
-    GL_CALL(vertHandle = glCreateShader(GL_VERTEX_SHADER));
-    glShaderSource(vertHandle, 1, &vertexShader, nullptr);
-    glCompileShader(vertHandle);
-    ok &= GL::CheckShader(vertHandle, "vertex shader");
+GL::PendingProgram::~PendingProgram() { Destroy(); }
 
-    GLuint fragHandle;
-    GL_CALL(fragHandle = glCreateShader(GL_FRAGMENT_SHADER));
-    glShaderSource(fragHandle, 1, &fragmentShader, nullptr);
-    glCompileShader(fragHandle);
-    ok &= GL::CheckShader(fragHandle, "fragment shader");
+GL::PendingProgram::PendingProgram(PendingProgram&& other) noexcept
+{
+    *this = std::move(other);
+}
 
-    // Link
-    auto shaderHandle = glCreateProgram();
-    glAttachShader(shaderHandle, vertHandle);
-    glAttachShader(shaderHandle, fragHandle);
-    glLinkProgram(shaderHandle);
-    ok &= GL::CheckProgram(shaderHandle, "shader program");
+GL::PendingProgram&
+GL::PendingProgram::operator=(PendingProgram&& other) noexcept
+{
+    if (this != &other) {
+        Destroy();
+        state_ = std::exchange(other.state_, State::Empty);
+        program_ = std::exchange(other.program_, 0);
+        vertHandle_ = std::exchange(other.vertHandle_, 0);
+        fragHandle_ = std::exchange(other.fragHandle_, 0);
+        cacheKey_ = other.cacheKey_;
+        buildNs_ = other.buildNs_;
+    }
+    return *this;
+}
 
-    glDetachShader(shaderHandle, vertHandle);
-    glDetachShader(shaderHandle, fragHandle);
-    glDeleteShader(vertHandle);
-    glDeleteShader(fragHandle);
+bool GL::PendingProgram::IsReady()
+{
+    if (state_ == State::Compiling) {
+        // without parallel compile the status query in Finish() may block
+        if (GLAD_GL_KHR_parallel_shader_compile
+            || GLAD_GL_ARB_parallel_shader_compile) {
+            GLint completed = GL_FALSE;
+            glGetProgramiv(program_, GL_COMPLETION_STATUS_KHR, &completed);
+            if (!completed) {
+                return false;
+            }
+        }
+        Finish();
+    }
+    return state_ == State::Ready;
+}
+
+GLuint GL::PendingProgram::Get()
+{
+    if (state_ == State::Compiling) {
+        Finish();
+    }
+    return state_ == State::Ready ? program_ : 0;
+}
+
+GLuint GL::PendingProgram::Release()
+{
+    const auto program = Get();
+    if (program) {
+        program_ = 0;
+        state_ = State::Empty;
+    }
+    return program;
+}
+
+void GL::PendingProgram::Finish()
+{
+    const auto start = SDL_GetTicksNS();
+    bool       ok = true;
+    ok &= GL::CheckShader(vertHandle_, "vertex shader");
+    ok &= GL::CheckShader(fragHandle_, "fragment shader");
+    ok &= GL::CheckProgram(program_, "shader program");
+
+    glDetachShader(program_, vertHandle_);
+    glDetachShader(program_, fragHandle_);
+    glDeleteShader(vertHandle_);
+    glDeleteShader(fragHandle_);
+    vertHandle_ = 0;
+    fragHandle_ = 0;
+    buildNs_ += SDL_GetTicksNS() - start;
 
     if (!ok) {
-        glDeleteShader(shaderHandle);
-        shaderHandle = 0;
+        glDeleteProgram(program_);
+        program_ = 0;
+        state_ = State::Failed;
+        return;
+    }
+    state_ = State::Ready;
+    if (auto* cache = GL::GetProgramCache()) {
+        // With parallel compile most of the work ran on driver threads while
+        // nothing waited for it, so this is what the app itself was held
+        // up, which is what a cache hit saves it.
+        cache->Store(cacheKey_, program_, buildNs_);
+    }
+}
+
+void GL::PendingProgram::Destroy()
+{
+    if (vertHandle_) {
+        glDeleteShader(vertHandle_);
+        glDeleteShader(fragHandle_);
+        vertHandle_ = 0;
+        fragHandle_ = 0;
+    }
+    if (program_) {
+        glDeleteProgram(program_);
+        GetStateCache().OnDeleted(GL_PROGRAM, program_);
+        program_ = 0;
+    }
+    state_ = State::Empty;
+}
+
+GLuint GL::CreateShader(const GLchar* vertexShader, const GLchar* fragmentShader)
+{
+    return PendingProgram(vertexShader, fragmentShader).Release();
+}
+
+GL::FrameFences::FrameFences(uint32_t depth)
+    : depth_(std::clamp<uint32_t>(depth, 1, MaxDepth))
+{
+}
+
+GL::FrameFences::~FrameFences()
+{
+    for (auto fence : fences_) {
+        if (fence) {
+            glDeleteSync(fence);
+        }
+    }
+}
+
+uint64_t GL::FrameFences::Begin()
+{
+    // the fence of frame_ - depth_ is waited for below
+    completed_ = frame_ + 1 >= depth_ ? frame_ + 1 - depth_ : 0;
+    auto& fence = fences_[GetFrameIndex()];
+    if (!fence) {
+        return 0;
+    }
+
+    uint64_t waited = 0;
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        const auto start = SDL_GetTicksNS();
+        // the first wait flushes, otherwise the fence may never be submitted
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (true) {
+            const auto res = glClientWaitSync(fence, flags, SDL_NS_PER_SECOND);
+            if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED) {
+                break;
+            }
+            if (res == GL_WAIT_FAILED) {
+                SPDLOG_ERROR("glClientWaitSync() failed for frame {}", frame_);
+                break;
+            }
+            flags = 0;
+        }
+        waited = SDL_GetTicksNS() - start;
+        stats_.waits.fetch_add(1, std::memory_order_relaxed);
+        stats_.waitNs.fetch_add(waited, std::memory_order_relaxed);
+        if (waited > stats_.maxWaitNs.load(std::memory_order_relaxed)) {
+            stats_.maxWaitNs.store(waited, std::memory_order_relaxed);
+        }
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+    return waited;
+}
+
+void GL::FrameFences::End()
+{
+    auto& fence = fences_[GetFrameIndex()];
+    if (fence) {
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++frame_;
+    stats_.frames.fetch_add(1, std::memory_order_relaxed);
+}
+
+static constexpr std::array<GLenum, GL::StateCache::BufferCount> BufferTargets
+    = {
+          GL_ARRAY_BUFFER,   GL_ELEMENT_ARRAY_BUFFER,  GL_PIXEL_UNPACK_BUFFER,
+          GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER, GL_DRAW_INDIRECT_BUFFER,
+      };
+
+static constexpr std::array<GLenum, GL::StateCache::CapCount> Caps = {
+    GL_BLEND,        GL_CULL_FACE,    GL_DEPTH_TEST,
+    GL_STENCIL_TEST, GL_SCISSOR_TEST, GL_PRIMITIVE_RESTART,
+    GL_CLIP_DISTANCE0, GL_CLIP_DISTANCE1, GL_CLIP_DISTANCE2,
+    GL_CLIP_DISTANCE3,
+};
+
+template <size_t N>
+static int FindIndex(const std::array<GLenum, N>& values, GLenum value)
+{
+    const auto it = std::find(values.begin(), values.end(), value);
+    return it == values.end() ? -1 : (int)(it - values.begin());
+}
+
+bool GL::StateCache::Update(GLuint& cached, GLuint value)
+{
+    if (cached == value) {
+        ++frame_.elided;
+        return false;
     }
+    cached = value;
+    ++frame_.issued;
+    return true;
+}
 
-    return shaderHandle;
+bool GL::StateCache::Update(std::array<GLint, 4>&       cached,
+                            const std::array<GLint, 4>& value)
+{
+    if (cached == value) {
+        ++frame_.elided;
+        return false;
+    }
+    cached = value;
+    ++frame_.issued;
+    return true;
+}
+
+void GL::StateCache::UseProgram(GLuint program)
+{
+    if (Update(state_.program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void GL::StateCache::BindVertexArray(GLuint vertexArray)
+{
+    if (Update(state_.vertexArray, vertexArray)) {
+        glBindVertexArray(vertexArray);
+        state_.buffers[ElementArrayBuffer] = Unknown;
+    }
+}
+
+void GL::StateCache::BindBuffer(GLenum target, GLuint buffer)
+{
+    const auto index = FindIndex(BufferTargets, target);
+    if (index < 0) {
+        ++frame_.issued;
+        glBindBuffer(target, buffer);
+    } else if (Update(state_.buffers[index], buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void GL::StateCache::BindBufferRange(GLenum target, GLuint index,
+                                     GLuint buffer, GLintptr offset,
+                                     GLsizeiptr size)
+{
+    const auto generic = FindIndex(BufferTargets, target);
+    if (generic >= 0) {
+        state_.buffers[generic] = buffer;
+    }
+    ++frame_.issued;
+    glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void GL::StateCache::BindTexture(GLuint unit, GLuint texture)
+{
+    if (unit >= TextureUnits) {
+        ++frame_.issued;
+        glBindTextureUnit(unit, texture);
+    } else if (Update(state_.textures[unit], texture)) {
+        glBindTextureUnit(unit, texture);
+    }
+}
+
+void GL::StateCache::BindSampler(GLuint unit, GLuint sampler)
+{
+    if (unit >= TextureUnits) {
+        ++frame_.issued;
+        glBindSampler(unit, sampler);
+    } else if (Update(state_.samplers[unit], sampler)) {
+        glBindSampler(unit, sampler);
+    }
+}
+
+void GL::StateCache::SetEnabled(GLenum cap, bool enabled)
+{
+    const auto index = FindIndex(Caps, cap);
+    if (index >= 0 && !Update(state_.caps[index], enabled)) {
+        return;
+    }
+    if (index < 0) {
+        ++frame_.issued;
+    }
+    if (enabled) {
+        glEnable(cap);
+    } else {
+        glDisable(cap);
+    }
+}
+
+void GL::StateCache::BlendEquation(GLenum rgb, GLenum alpha)
+{
+    if (state_.blendEquation == std::array<GLenum, 2>{rgb, alpha}) {
+        ++frame_.elided;
+        return;
+    }
+    state_.blendEquation = {rgb, alpha};
+    ++frame_.issued;
+    glBlendEquationSeparate(rgb, alpha);
+}
+
+void GL::StateCache::BlendFunc(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha,
+                               GLenum dstAlpha)
+{
+    const std::array<GLenum, 4> value = {srcRgb, dstRgb, srcAlpha, dstAlpha};
+    if (state_.blendFunc == value) {
+        ++frame_.elided;
+        return;
+    }
+    state_.blendFunc = value;
+    ++frame_.issued;
+    glBlendFuncSeparate(srcRgb, dstRgb, srcAlpha, dstAlpha);
+}
+
+void GL::StateCache::PolygonMode(GLenum mode)
+{
+    if (Update(state_.polygonMode, mode)) {
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+    }
+}
+
+void GL::StateCache::ClipControl(GLenum origin, GLenum depth)
+{
+    if (state_.clipOrigin == origin && state_.clipDepth == depth) {
+        ++frame_.elided;
+        return;
+    }
+    state_.clipOrigin = origin;
+    state_.clipDepth = depth;
+    ++frame_.issued;
+    glClipControl(origin, depth);
+}
+
+void GL::StateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (Update(state_.viewport, {x, y, width, height})) {
+        glViewport(x, y, width, height);
+    }
+}
+
+void GL::StateCache::Scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (Update(state_.scissor, {x, y, width, height})) {
+        glScissor(x, y, width, height);
+    }
+}
+
+void GL::StateCache::Restore(const Snapshot& snapshot)
+{
+    if (snapshot.program != Unknown) {
+        UseProgram(snapshot.program);
+    }
+    // the element array buffer is restored along with its vertex array
+    if (snapshot.vertexArray != Unknown) {
+        BindVertexArray(snapshot.vertexArray);
+    }
+    for (int i = 0; i < BufferCount; ++i) {
+        if (i != ElementArrayBuffer && snapshot.buffers[i] != Unknown) {
+            BindBuffer(BufferTargets[i], snapshot.buffers[i]);
+        }
+    }
+    for (GLuint unit = 0; unit < TextureUnits; ++unit) {
+        if (snapshot.textures[unit] != Unknown) {
+            BindTexture(unit, snapshot.textures[unit]);
+        }
+        if (snapshot.samplers[unit] != Unknown) {
+            BindSampler(unit, snapshot.samplers[unit]);
+        }
+    }
+    for (int i = 0; i < CapCount; ++i) {
+        if (snapshot.caps[i] != Unknown) {
+            SetEnabled(Caps[i], snapshot.caps[i]);
+        }
+    }
+    if (snapshot.blendEquation[0] != Unknown) {
+        BlendEquation(snapshot.blendEquation[0], snapshot.blendEquation[1]);
+    }
+    if (snapshot.blendFunc[0] != Unknown) {
+        BlendFunc(snapshot.blendFunc[0], snapshot.blendFunc[1],
+                  snapshot.blendFunc[2], snapshot.blendFunc[3]);
+    }
+    if (snapshot.polygonMode != Unknown) {
+        PolygonMode(snapshot.polygonMode);
+    }
+    if (snapshot.clipOrigin != Unknown) {
+        ClipControl(snapshot.clipOrigin, snapshot.clipDepth);
+    }
+    if (snapshot.viewport[2] >= 0) {
+        Viewport(snapshot.viewport[0], snapshot.viewport[1],
+                 snapshot.viewport[2], snapshot.viewport[3]);
+    }
+    if (snapshot.scissor[2] >= 0) {
+        Scissor(snapshot.scissor[0], snapshot.scissor[1], snapshot.scissor[2],
+                snapshot.scissor[3]);
+    }
+}
+
+void GL::StateCache::Invalidate()
+{
+    state_.program = Unknown;
+    state_.vertexArray = Unknown;
+    state_.buffers.fill(Unknown);
+    state_.textures.fill(Unknown);
+    state_.samplers.fill(Unknown);
+    state_.caps.fill(Unknown);
+    state_.blendEquation.fill(Unknown);
+    state_.blendFunc.fill(Unknown);
+    state_.polygonMode = Unknown;
+    state_.clipOrigin = Unknown;
+    state_.clipDepth = Unknown;
+    state_.viewport = {-1, -1, -1, -1};
+    state_.scissor = {-1, -1, -1, -1};
+}
+
+void GL::StateCache::OnDeleted(GLenum identifier, GLuint name)
+{
+    if (!name) {
+        return;
+    }
+    switch (identifier) {
+    case GL_PROGRAM:
+        // a current program stays in use until another one is made current
+        if (state_.program == name) {
+            state_.program = Unknown;
+        }
+        break;
+    case GL_VERTEX_ARRAY:
+        if (state_.vertexArray == name) {
+            state_.vertexArray = 0;
+            state_.buffers[ElementArrayBuffer] = 0;
+        }
+        break;
+    case GL_BUFFER:
+        // GL unbinds it from every target of the context and from the
+        // bound vertex array, which is the only one the cache knows about
+        for (auto& buffer : state_.buffers) {
+            if (buffer == name) {
+                buffer = 0;
+            }
+        }
+        break;
+    case GL_TEXTURE:
+        for (auto& texture : state_.textures) {
+            if (texture == name) {
+                texture = 0;
+            }
+        }
+        break;
+    case GL_SAMPLER:
+        for (auto& sampler : state_.samplers) {
+            if (sampler == name) {
+                sampler = 0;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void GL::StateCache::BeginFrame()
+{
+    lastIssued_.store(frame_.issued, std::memory_order_relaxed);
+    lastElided_.store(frame_.elided, std::memory_order_relaxed);
+    frame_ = {};
+}
+
+GL::StateCache::Counters GL::StateCache::GetLastFrameCounters() const
+{
+    return {lastIssued_.load(std::memory_order_relaxed),
+            lastElided_.load(std::memory_order_relaxed)};
+}
+
+GL::StateCache& GL::GetStateCache()
+{
+    static StateCache cache;
+    return cache;
+}
+
+int64_t GL::ResourceStats::GetObjects() const
+{
+    int64_t total = 0;
+    for (const auto& count : objects) {
+        total += count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+int64_t GL::ResourceStats::GetBytes() const
+{
+    int64_t total = 0;
+    for (const auto& count : bytes) {
+        total += count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+namespace {
+
+std::mutex g_resourceStatsMutex;
+std::unordered_map<const void*, std::unique_ptr<GL::ResourceStats>>
+    g_resourceStats;
+
+GL::ResourceStats& GetOwnerStats(const void* owner)
+{
+    std::lock_guard lock(g_resourceStatsMutex);
+    auto& stats = g_resourceStats[owner];
+    if (!stats) {
+        stats = std::make_unique<GL::ResourceStats>();
+    }
+    return *stats;
+}
+
+} // namespace
+
+const GL::ResourceStats& GL::GetResourceStats(const void* owner)
+{
+    return GetOwnerStats(owner);
+}
+
+GLuint GL::Detail::CreateObject(ObjectType type)
+{
+    GLuint name = 0;
+    switch (type) {
+    case ObjectType::Buffer:
+        glCreateBuffers(1, &name);
+        break;
+    case ObjectType::VertexArray:
+        glCreateVertexArrays(1, &name);
+        break;
+    case ObjectType::Program:
+        name = glCreateProgram();
+        break;
+    case ObjectType::Texture:
+        glCreateTextures(GL_TEXTURE_2D, 1, &name);
+        break;
+    case ObjectType::Sampler:
+        glCreateSamplers(1, &name);
+        break;
+    case ObjectType::Framebuffer:
+        glCreateFramebuffers(1, &name);
+        break;
+    case ObjectType::Renderbuffer:
+        glCreateRenderbuffers(1, &name);
+        break;
+    default:
+        break;
+    }
+    return name;
+}
+
+void GL::Detail::TrackObject(ObjectType type, const void* owner,
+                             int64_t objects, int64_t bytes)
+{
+    auto& stats = GetOwnerStats(owner);
+    stats.objects[(size_t)type].fetch_add(objects, std::memory_order_relaxed);
+    stats.bytes[(size_t)type].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void GL::DeletionQueue::Enqueue(ObjectType type, GLuint name,
+                                const void* owner, int64_t bytes)
+{
+    Entry entry{ type, name, owner, bytes, 0 };
+    if (!fences_) {
+        Delete(entry);
+        return;
+    }
+    entry.frame = fences_->GetFrameNumber();
+    GetOwnerStats(owner).pending.fetch_add(1, std::memory_order_relaxed);
+    entries_.push_back(entry);
+}
+
+void GL::DeletionQueue::Collect()
+{
+    if (!fences_) {
+        return;
+    }
+    const auto completed = fences_->GetCompletedFrames();
+    const auto end = std::find_if(entries_.begin(), entries_.end(),
+                                  [completed](const Entry& entry) {
+                                      return entry.frame >= completed;
+                                  });
+    for (auto it = entries_.begin(); it != end; ++it) {
+        Delete(*it);
+        GetOwnerStats(it->owner).pending.fetch_sub(1,
+                                                   std::memory_order_relaxed);
+    }
+    entries_.erase(entries_.begin(), end);
+}
+
+void GL::DeletionQueue::Flush()
+{
+    if (entries_.empty()) {
+        return;
+    }
+    glFinish();
+    for (const auto& entry : entries_) {
+        Delete(entry);
+        GetOwnerStats(entry.owner).pending.fetch_sub(
+            1, std::memory_order_relaxed);
+    }
+    entries_.clear();
+}
+
+void GL::DeletionQueue::Delete(const Entry& entry)
+{
+    auto& state = GetStateCache();
+    switch (entry.type) {
+    case ObjectType::Buffer:
+        glDeleteBuffers(1, &entry.name);
+        state.OnDeleted(GL_BUFFER, entry.name);
+        break;
+    case ObjectType::VertexArray:
+        glDeleteVertexArrays(1, &entry.name);
+        state.OnDeleted(GL_VERTEX_ARRAY, entry.name);
+        break;
+    case ObjectType::Program:
+        glDeleteProgram(entry.name);
+        state.OnDeleted(GL_PROGRAM, entry.name);
+        break;
+    case ObjectType::Texture:
+        glDeleteTextures(1, &entry.name);
+        state.OnDeleted(GL_TEXTURE, entry.name);
+        break;
+    case ObjectType::Sampler:
+        glDeleteSamplers(1, &entry.name);
+        state.OnDeleted(GL_SAMPLER, entry.name);
+        break;
+    case ObjectType::Framebuffer:
+        glDeleteFramebuffers(1, &entry.name);
+        break;
+    case ObjectType::Renderbuffer:
+        glDeleteRenderbuffers(1, &entry.name);
+        break;
+    default:
+        break;
+    }
+    Detail::TrackObject(entry.type, entry.owner, -1, -entry.bytes);
+}
+
+GL::DeletionQueue& GL::GetDeletionQueue()
+{
+    static DeletionQueue queue;
+    return queue;
 }
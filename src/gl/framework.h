@@ -2,14 +2,29 @@
 
 #include <glad/glad.h>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "validation.h"
+
+// With OPENGL_DEBUG, GL::Validation::Sync and higher record the call site
+// for debug messages and Full checks glGetError() after the call; lower
+// tiers cost two loads. Without it the call is left alone.
 #ifdef OPENGL_DEBUG
-#include <spdlog/spdlog.h>
 #define GL_CALL(_CALL)                                                          \
     do {                                                                        \
+        const bool gl_check                                                     \
+            = GL::Detail::g_checkCalls.load(std::memory_order_relaxed)          \
+            || GL::Detail::g_scopeCheckCalls;                                   \
+        if (gl_check) {                                                         \
+            GL::Detail::BeginCall(#_CALL, __FILE__, __LINE__);                  \
+        }                                                                       \
         _CALL;                                                                  \
-        GLenum gl_err = glGetError();                                           \
-        if (gl_err != 0) {                                                      \
-            SPDLOG_ERROR("GL error {} returned from '{}'", gl_err, #_CALL);    \
+        if (gl_check) {                                                         \
+            GL::Detail::EndCall();                                              \
         }                                                                       \
     } while (0) // Call with error check
 #else
@@ -20,6 +35,383 @@ namespace GL {
 
 bool CheckShader(GLuint handle, const char* desc);
 bool CheckProgram(GLuint handle, const char* desc);
+// Lets the driver compile and link on its own threads when it supports
+// GL_KHR_parallel_shader_compile (or the ARB variant), returns false if not.
+bool EnableParallelShaderCompile();
+
+// A program whose compile and link were started but whose status has not
+// been queried yet: a status query waits for the driver, so it is only done
+// once the program is polled with IsReady() or needed by Get()/Release().
+// Starting every program of a canvas up front overlaps their compiles; with
+// parallel compile IsReady() never blocks, so the canvas can draw a
+// placeholder until it returns true. Goes through the program cache when
+// one is installed, a hit is ready at once. Owns the program.
+class PendingProgram
+{
+public:
+    PendingProgram() = default; // empty, never becomes ready
+    PendingProgram(const GLchar* vertexShader, const GLchar* fragmentShader);
+    ~PendingProgram();
+    PendingProgram(const PendingProgram&) = delete;
+    PendingProgram(PendingProgram&& other) noexcept;
+    PendingProgram& operator=(const PendingProgram&) = delete;
+    PendingProgram& operator=(PendingProgram&& other) noexcept;
+
+    // True once the program is linked. Never blocks with parallel compile.
+    bool IsReady();
+    // True if compiling or linking failed, the log has been printed.
+    bool IsFailed() const { return state_ == State::Failed; }
+    // Default constructed, released or failed and reset.
+    bool IsEmpty() const { return state_ == State::Empty; }
+    // Waits for the program, 0 if it failed.
+    GLuint Get();
+    // The program if it is ready, otherwise 0.
+    GLuint TryGet() { return IsReady() ? program_ : 0; }
+    // Get() and hands the ownership of the program over to the caller.
+    GLuint Release();
+
+private:
+    enum class State
+    {
+        Empty,
+        Compiling,
+        Ready,
+        Failed,
+    };
+
+    void Finish(); // checks the results, Compiling -> Ready/Failed
+    void Destroy();
+
+private:
+    State    state_ = State::Empty;
+    GLuint   program_ = 0;
+    GLuint   vertHandle_ = 0;
+    GLuint   fragHandle_ = 0;
+    uint64_t cacheKey_ = 0;
+    // Time spent in the compile/link calls and the status queries, which
+    // wait for the driver. The idle time between polls is left out.
+    uint64_t buildNs_ = 0;
+};
+
+// Compiles and links synchronously, 0 on failure.
 GLuint CreateShader(const GLchar* vertexShader, const GLchar* fragmentShader);
 
+// Shadow copy of the GL state of the render context. Setters skip calls
+// that would not change anything, so code can set what it needs without
+// checking, and Save()/Restore() replace glGet round-trips. The copy is only
+// right while every change of the tracked state goes through the cache:
+// code that bypasses it must call Invalidate(), deleting a bound object
+// must be reported with OnDeleted().
+class StateCache
+{
+public:
+    static constexpr uint32_t TextureUnits = 16;
+    static constexpr GLuint   Unknown = ~0u; // next set is always issued
+
+    enum Buffer
+    {
+        ArrayBuffer,
+        ElementArrayBuffer, // part of the bound vertex array
+        PixelUnpackBuffer,
+        UniformBuffer,
+        ShaderStorageBuffer,
+        DrawIndirectBuffer,
+        BufferCount
+    };
+
+    enum Cap
+    {
+        Blend,
+        CullFace,
+        DepthTest,
+        StencilTest,
+        ScissorTest,
+        PrimitiveRestart,
+        ClipDistance0,
+        ClipDistance1,
+        ClipDistance2,
+        ClipDistance3,
+        CapCount
+    };
+
+    struct Snapshot
+    {
+        GLuint                              program = 0;
+        GLuint                              vertexArray = 0;
+        std::array<GLuint, BufferCount>     buffers = {};
+        std::array<GLuint, TextureUnits>    textures = {};
+        std::array<GLuint, TextureUnits>    samplers = {};
+        std::array<GLuint, CapCount>        caps = {}; // GL_FALSE/GL_TRUE
+        std::array<GLenum, 2> blendEquation = {GL_FUNC_ADD, GL_FUNC_ADD};
+        std::array<GLenum, 4> blendFunc = {GL_ONE, GL_ZERO, GL_ONE, GL_ZERO};
+        GLenum                              polygonMode = GL_FILL;
+        GLenum                              clipOrigin = GL_LOWER_LEFT;
+        GLenum                              clipDepth = GL_NEGATIVE_ONE_TO_ONE;
+        std::array<GLint, 4> viewport = {-1, -1, -1, -1}; // -1 - unknown
+        std::array<GLint, 4> scissor = {-1, -1, -1, -1};
+    };
+
+    struct Counters
+    {
+        uint64_t issued = 0;
+        uint64_t elided = 0;
+    };
+
+    void UseProgram(GLuint program);
+    void BindVertexArray(GLuint vertexArray);
+    // Untracked targets are passed through.
+    void BindBuffer(GLenum target, GLuint buffer);
+    // Always issued, it also binds the generic binding point of target.
+    void BindBufferRange(GLenum target, GLuint index, GLuint buffer,
+                         GLintptr offset, GLsizeiptr size);
+    // glBindTextureUnit, the active texture unit is never changed.
+    void BindTexture(GLuint unit, GLuint texture);
+    void BindSampler(GLuint unit, GLuint sampler);
+    // Untracked caps are passed through.
+    void SetEnabled(GLenum cap, bool enabled);
+    void BlendEquation(GLenum rgb, GLenum alpha);
+    void BlendFunc(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha,
+                   GLenum dstAlpha);
+    void PolygonMode(GLenum mode);
+    void ClipControl(GLenum origin, GLenum depth);
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    void Scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    const Snapshot& GetCurrent() const { return state_; }
+    Snapshot        Save() const { return state_; }
+    // Unknown values of the snapshot are left as they are.
+    void Restore(const Snapshot& snapshot);
+
+    // Forgets everything, e.g. after third party code changed the state.
+    void Invalidate();
+    // identifier as in glObjectLabel: GL_PROGRAM, GL_VERTEX_ARRAY,
+    // GL_BUFFER or GL_TEXTURE
+    void OnDeleted(GLenum identifier, GLuint name);
+
+    // Counters are per frame: BeginFrame() publishes those of the frame that
+    // ended, GetLastFrameCounters() may be read from any thread.
+    void     BeginFrame();
+    Counters GetLastFrameCounters() const;
+
+private:
+    // true if the call has to be issued
+    bool Update(GLuint& cached, GLuint value);
+    bool Update(std::array<GLint, 4>& cached, const std::array<GLint, 4>& value);
+
+private:
+    Snapshot              state_; // a new context, viewport/scissor unknown
+    Counters              frame_;
+    std::atomic<uint64_t> lastIssued_ = 0;
+    std::atomic<uint64_t> lastElided_ = 0;
+};
+
+// The cache of the render context, used by whichever thread holds it.
+StateCache& GetStateCache();
+
+// Limits how many frames the CPU may queue ahead of the GPU. Begin() waits
+// until the frame that used the same slot depth frames ago has finished on
+// the GPU, End() fences the commands of the current frame. Streaming buffers
+// split into GetDepth() regions can safely write region GetFrameIndex()
+// between Begin() and End().
+class FrameFences
+{
+public:
+    static constexpr uint32_t MaxDepth = 4;
+
+    // Readable from any thread.
+    struct Stats
+    {
+        std::atomic<uint64_t> frames = 0;
+        std::atomic<uint64_t> waits = 0; // frames that had to wait
+        std::atomic<uint64_t> waitNs = 0;
+        std::atomic<uint64_t> maxWaitNs = 0;
+    };
+
+    // depth is clamped to [1, MaxDepth]
+    explicit FrameFences(uint32_t depth = 2);
+    ~FrameFences();
+    FrameFences(const FrameFences&) = delete;
+    FrameFences(FrameFences&&) = delete;
+    FrameFences& operator=(const FrameFences&) = delete;
+    FrameFences& operator=(FrameFences&&) = delete;
+
+    // Returns how long the CPU waited, nanoseconds.
+    uint64_t Begin();
+    void     End();
+
+    uint32_t     GetDepth() const { return depth_; }
+    uint32_t     GetFrameIndex() const { return (uint32_t)(frame_ % depth_); }
+    uint64_t     GetFrameNumber() const { return frame_; }
+    // Frames numbered below this have finished on the GPU, valid after
+    // Begin().
+    uint64_t     GetCompletedFrames() const { return completed_; }
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    uint32_t                      depth_;
+    uint64_t                      frame_ = 0;
+    uint64_t                      completed_ = 0;
+    std::array<GLsync, MaxDepth>  fences_ = {};
+    Stats                         stats_;
+};
+
+enum class ObjectType
+{
+    Buffer,
+    VertexArray,
+    Program,
+    Texture,
+    Sampler,
+    Framebuffer,
+    Renderbuffer,
+    Count
+};
+
+// Live objects of one owner, e.g. a canvas. Counted when a handle takes an
+// object and uncounted when the object is really deleted, so objects still
+// waiting in the DeletionQueue are included. Readable from any thread.
+struct ResourceStats
+{
+    static constexpr size_t TypeCount = (size_t)ObjectType::Count;
+
+    std::array<std::atomic<int64_t>, TypeCount> objects = {};
+    std::array<std::atomic<int64_t>, TypeCount> bytes = {};
+    std::atomic<int64_t> pending = 0; // queued for deletion
+
+    int64_t GetObjects() const;
+    int64_t GetBytes() const;
+};
+
+// Stats of owner, created on first use. nullptr collects unowned objects.
+const ResourceStats& GetResourceStats(const void* owner);
+
+// Deleting an object the GPU may still use makes the driver synchronize.
+// Handles hand their objects over here instead; they are deleted once the
+// fence of the frame they were released in has signaled, i.e. after every
+// command that may have used them has finished.
+class DeletionQueue
+{
+public:
+    DeletionQueue() = default;
+    DeletionQueue(const DeletionQueue&) = delete;
+    DeletionQueue(DeletionQueue&&) = delete;
+    DeletionQueue& operator=(const DeletionQueue&) = delete;
+    DeletionQueue& operator=(DeletionQueue&&) = delete;
+
+    // Without fences (the default) objects are deleted right away.
+    void SetFrameFences(const FrameFences* fences) { fences_ = fences; }
+
+    void Enqueue(ObjectType type, GLuint name, const void* owner,
+                 int64_t bytes);
+    // Deletes the objects whose frames have finished, called after
+    // FrameFences::Begin().
+    void Collect();
+    // Waits for the GPU and deletes everything, e.g. on shutdown.
+    void Flush();
+
+private:
+    struct Entry
+    {
+        ObjectType  type;
+        GLuint      name;
+        const void* owner;
+        int64_t     bytes;
+        uint64_t    frame; // FrameFences::GetFrameNumber() when enqueued
+    };
+
+    static void Delete(const Entry& entry);
+
+private:
+    const FrameFences* fences_ = nullptr;
+    std::vector<Entry> entries_; // in frame order
+};
+
+// The queue of the render context, used by whichever thread holds it.
+DeletionQueue& GetDeletionQueue();
+
+namespace Detail {
+GLuint CreateObject(ObjectType type);
+void   TrackObject(ObjectType type, const void* owner, int64_t objects,
+                   int64_t bytes);
+} // namespace Detail
+
+// Owns one GL object of the given type and releases it through the
+// DeletionQueue. owner only selects the ResourceStats the object is
+// counted in, bytes are what the owner reports as its storage.
+template <ObjectType type>
+class Handle
+{
+public:
+    Handle() = default;
+    // Takes over name, e.g. one made with glGen*() or by the upload service.
+    Handle(GLuint name, const void* owner, int64_t bytes = 0)
+        : name_(name)
+        , owner_(owner)
+        , bytes_(bytes)
+    {
+        if (name_) {
+            Detail::TrackObject(type, owner_, 1, bytes_);
+        }
+    }
+    // glCreate*(), 2D for textures.
+    static Handle Create(const void* owner)
+    {
+        return Handle(Detail::CreateObject(type), owner);
+    }
+
+    ~Handle() { Reset(); }
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+    Handle(Handle&& other) noexcept
+        : name_(std::exchange(other.name_, 0))
+        , owner_(other.owner_)
+        , bytes_(std::exchange(other.bytes_, 0))
+    {
+    }
+    Handle& operator=(Handle&& other) noexcept
+    {
+        if (this != &other) {
+            Reset();
+            name_ = std::exchange(other.name_, 0);
+            owner_ = other.owner_;
+            bytes_ = std::exchange(other.bytes_, 0);
+        }
+        return *this;
+    }
+
+    GLuint   Get() const { return name_; }
+    explicit operator bool() const { return name_ != 0; }
+
+    // After (re)allocating the storage of the object.
+    void SetBytes(int64_t bytes)
+    {
+        if (name_) {
+            Detail::TrackObject(type, owner_, 0, bytes - bytes_);
+            bytes_ = bytes;
+        }
+    }
+
+    // Queues the object for deletion, the handle becomes empty.
+    void Reset()
+    {
+        if (name_) {
+            GetDeletionQueue().Enqueue(type, std::exchange(name_, 0), owner_,
+                                       std::exchange(bytes_, 0));
+        }
+    }
+
+private:
+    GLuint      name_ = 0;
+    const void* owner_ = nullptr;
+    int64_t     bytes_ = 0;
+};
+
+using Buffer = Handle<ObjectType::Buffer>;
+using VertexArray = Handle<ObjectType::VertexArray>;
+using Program = Handle<ObjectType::Program>;
+using Texture = Handle<ObjectType::Texture>;
+using Sampler = Handle<ObjectType::Sampler>;
+using Framebuffer = Handle<ObjectType::Framebuffer>;
+using Renderbuffer = Handle<ObjectType::Renderbuffer>;
+
 } // namespace GL
\ No newline at end of file
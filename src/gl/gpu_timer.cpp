@@ -0,0 +1,71 @@
+#include "gpu_timer.h"
+#include "framework.h"
+
+#include <cassert>
+
+GL::GpuTimer::GpuTimer(size_t scopes)
+    : scopes_(scopes)
+{
+}
+
+GL::GpuTimer::~GpuTimer()
+{
+    for (auto& query : queries_) {
+        glDeleteQueries(1, &query.id);
+    }
+}
+
+bool GL::GpuTimer::IsSupported()
+{
+    // core since 3.3, Mesa (llvmpipe included) exposes it everywhere
+    return GLVersion.major > 3 || (GLVersion.major == 3 && GLVersion.minor >= 3)
+        || GLAD_GL_ARB_timer_query;
+}
+
+void GL::GpuTimer::BeginFrame(const ResultCallback& onResult)
+{
+    assert(!active_);
+    if (queries_.empty()) {
+        // created lazily, the context may not be current at construction
+        queries_.resize(Latency * scopes_);
+        for (auto& query : queries_) {
+            GL_CALL(glGenQueries(1, &query.id));
+        }
+    }
+
+    frame_ = (frame_ + 1) % Latency;
+    for (size_t scope = 0; scope < scopes_; ++scope) {
+        auto& query = GetQuery(frame_, scope);
+        if (!query.pending) {
+            continue;
+        }
+        query.pending = false;
+
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            ++dropped_;
+            continue;
+        }
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &ns);
+        onResult(scope, ns);
+    }
+}
+
+void GL::GpuTimer::Begin(size_t scope)
+{
+    // GL_TIME_ELAPSED queries can not be nested
+    assert(!active_ && scope < scopes_ && !queries_.empty());
+    auto& query = GetQuery(frame_, scope);
+    GL_CALL(glBeginQuery(GL_TIME_ELAPSED, query.id));
+    query.pending = true;
+    active_ = true;
+}
+
+void GL::GpuTimer::End()
+{
+    assert(active_);
+    GL_CALL(glEndQuery(GL_TIME_ELAPSED));
+    active_ = false;
+}
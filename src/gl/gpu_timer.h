@@ -0,0 +1,83 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace GL {
+
+// Measures GPU time of a fixed number of scopes per frame with pooled
+// GL_TIME_ELAPSED queries. Results are read back Latency frames after they
+// were issued and only if they are already available, so the CPU never
+// waits for the GPU; results that are still not ready by then are dropped.
+class GpuTimer
+{
+public:
+    using ResultCallback = std::function<void(size_t scope, uint64_t ns)>;
+
+    static constexpr size_t Latency = 4;
+
+    explicit GpuTimer(size_t scopes);
+    ~GpuTimer();
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer(GpuTimer&&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+    GpuTimer& operator=(GpuTimer&&) = delete;
+
+    static bool IsSupported();
+
+    // Reports finished results of the frame slot that is about to be reused.
+    void BeginFrame(const ResultCallback& onResult);
+    void Begin(size_t scope);
+    void End();
+
+    uint64_t GetDroppedCount() const { return dropped_; }
+
+private:
+    struct Query
+    {
+        GLuint id = 0;
+        bool   pending = false;
+    };
+
+    Query& GetQuery(size_t frame, size_t scope)
+    {
+        return queries_[frame * scopes_ + scope];
+    }
+
+private:
+    std::vector<Query> queries_;
+    size_t             scopes_;
+    size_t             frame_ = 0;
+    bool               active_ = false;
+    uint64_t           dropped_ = 0;
+};
+
+// Times one scope of a (possibly null) timer for the lifetime of the object.
+class GpuTimerScope
+{
+public:
+    GpuTimerScope(GpuTimer* timer, size_t scope)
+        : timer_(timer)
+    {
+        if (timer_) {
+            timer_->Begin(scope);
+        }
+    }
+    ~GpuTimerScope()
+    {
+        if (timer_) {
+            timer_->End();
+        }
+    }
+    GpuTimerScope(const GpuTimerScope&) = delete;
+    GpuTimerScope& operator=(const GpuTimerScope&) = delete;
+
+private:
+    GpuTimer* timer_;
+};
+
+} // namespace GL
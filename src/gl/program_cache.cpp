@@ -0,0 +1,202 @@
+#include "program_cache.h"
+#include "framework.h"
+
+#include <SDL3/SDL.h>
+#include <spdlog/spdlog.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t FileMagic = 0x42505347; // "GSPB"
+constexpr uint32_t FileVersion = 1;
+// real binaries are a few hundred KiB at most
+constexpr uint64_t MaxBinarySize = 64 * 1024 * 1024;
+
+struct FileHeader
+{
+    uint32_t magic = FileMagic;
+    uint32_t version = FileVersion;
+    uint64_t key = 0;
+    uint64_t compileNs = 0;
+    uint32_t format = 0; // GLenum
+    uint32_t size = 0;
+};
+
+// FNV-1a, 64 bit
+constexpr uint64_t HashSeed = 0xcbf29ce484222325ull;
+uint64_t Hash(uint64_t hash, const void* data, size_t size)
+{
+    const auto* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+uint64_t Hash(uint64_t hash, std::string_view str)
+{
+    // the length keeps ("ab", "c") and ("a", "bc") apart
+    const uint64_t size = str.size();
+    hash = Hash(hash, &size, sizeof(size));
+    return Hash(hash, str.data(), str.size());
+}
+
+std::string_view GetString(GLenum name)
+{
+    const auto* str = (const char*)glGetString(name);
+    return str ? str : "";
+}
+
+GL::ProgramCache* g_programCache = nullptr;
+
+} // namespace
+
+GL::ProgramCache::ProgramCache(std::string directory)
+    : directory_(std::move(directory))
+{
+    driverHash_ = Hash(HashSeed, GetString(GL_VENDOR));
+    driverHash_ = Hash(driverHash_, GetString(GL_RENDERER));
+    driverHash_ = Hash(driverHash_, GetString(GL_VERSION));
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        SPDLOG_INFO("program cache disabled, the driver has no binary formats");
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        SPDLOG_ERROR("program cache disabled, could not create '{}': {}",
+                     directory_, error.message());
+        return;
+    }
+    enabled_ = true;
+}
+
+uint64_t
+GL::ProgramCache::MakeKey(std::initializer_list<std::string_view> sources) const
+{
+    auto key = driverHash_;
+    for (const auto source : sources) {
+        key = Hash(key, source);
+    }
+    return key;
+}
+
+GLuint GL::ProgramCache::Load(uint64_t key)
+{
+    if (!enabled_) {
+        return 0;
+    }
+
+    const auto start = SDL_GetTicksNS();
+    const auto path = GetPath(key);
+    auto*      file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        stats_.misses++;
+        return 0;
+    }
+
+    // the size is checked against the file before anything is allocated
+    std::error_code      sizeError;
+    const auto           fileSize = std::filesystem::file_size(path, sizeError);
+    FileHeader           header;
+    std::vector<uint8_t> blob;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+        && header.magic == FileMagic && header.version == FileVersion
+        && header.key == key && !sizeError && header.size <= MaxBinarySize
+        && fileSize == sizeof(header) + (uint64_t)header.size;
+    if (ok) {
+        blob.resize(header.size);
+        ok = std::fread(blob.data(), 1, blob.size(), file) == blob.size();
+    }
+    std::fclose(file);
+
+    GLuint program = 0;
+    if (ok) {
+        program = glCreateProgram();
+        glProgramBinary(program, header.format, blob.data(),
+                        (GLsizei)blob.size());
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        ok = status == GL_TRUE;
+    }
+    if (!ok) {
+        // truncated, from another build or refused by the driver: the next
+        // compile stores a fresh one
+        if (program) {
+            glDeleteProgram(program);
+        }
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        stats_.rejected++;
+        stats_.misses++;
+        return 0;
+    }
+
+    const auto loadNs = SDL_GetTicksNS() - start;
+    stats_.hits++;
+    stats_.loadNs += loadNs;
+    stats_.savedNs += header.compileNs > loadNs ? header.compileNs - loadNs : 0;
+    return program;
+}
+
+void GL::ProgramCache::Store(uint64_t key, GLuint program, uint64_t compileNs)
+{
+    if (!enabled_) {
+        return;
+    }
+    stats_.compileNs += compileNs;
+
+    GLint size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0) {
+        return;
+    }
+
+    FileHeader header;
+    header.key = key;
+    header.compileNs = compileNs;
+    std::vector<uint8_t> blob(size);
+    GLenum               format = GL_NONE;
+    GL_CALL(glGetProgramBinary(program, size, &size, &format, blob.data()));
+    header.format = format;
+    header.size = (uint32_t)size;
+
+    // written aside and renamed, so a crash never leaves a torn entry
+    const auto path = GetPath(key);
+    const auto tmpPath = path + ".tmp";
+    auto*      file = std::fopen(tmpPath.c_str(), "wb");
+    if (!file) {
+        SPDLOG_ERROR("could not write '{}'", tmpPath);
+        return;
+    }
+    const bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+        && std::fwrite(blob.data(), 1, header.size, file) == header.size;
+    std::fclose(file);
+
+    std::error_code error;
+    if (ok) {
+        std::filesystem::rename(tmpPath, path, error);
+    }
+    if (!ok || error) {
+        SPDLOG_ERROR("could not store program binary '{}'", path);
+        std::filesystem::remove(tmpPath, error);
+    }
+}
+
+std::string GL::ProgramCache::GetPath(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return (std::filesystem::path(directory_) / name).string();
+}
+
+void GL::SetProgramCache(ProgramCache* cache) { g_programCache = cache; }
+
+GL::ProgramCache* GL::GetProgramCache() { return g_programCache; }
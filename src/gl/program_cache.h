@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+namespace GL {
+
+// On-disk cache of linked program binaries. An entry is keyed by a hash of
+// the shader sources (defines included, they are part of the sources) and of
+// the driver's vendor, renderer and version strings, so a driver update
+// never loads a stale blob. A blob the driver rejects anyway is deleted and
+// the program is compiled from source. Used by CreateShader() once installed
+// with SetProgramCache(), all calls need the render context current.
+class ProgramCache
+{
+public:
+    // Readable from any thread.
+    struct Stats
+    {
+        std::atomic<uint64_t> hits = 0;
+        std::atomic<uint64_t> misses = 0;
+        std::atomic<uint64_t> rejected = 0; // blobs the driver refused
+        std::atomic<uint64_t> loadNs = 0;   // spent on hits
+        std::atomic<uint64_t> compileNs = 0; // spent on misses
+        std::atomic<uint64_t> savedNs = 0; // compile time of hits minus loadNs
+    };
+
+    // Creates directory if needed. The cache stays disabled (every Load()
+    // misses, Store() does nothing) if it can not be created or the driver
+    // supports no binary formats.
+    explicit ProgramCache(std::string directory);
+    ProgramCache(const ProgramCache&) = delete;
+    ProgramCache(ProgramCache&&) = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+    ProgramCache& operator=(ProgramCache&&) = delete;
+
+    uint64_t MakeKey(std::initializer_list<std::string_view> sources) const;
+
+    // A linked program, or 0 on a miss.
+    GLuint Load(uint64_t key);
+    // program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+    // compileNs is what a later hit saves.
+    void Store(uint64_t key, GLuint program, uint64_t compileNs);
+
+    bool         IsEnabled() const { return enabled_; }
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    std::string GetPath(uint64_t key) const;
+
+private:
+    std::string directory_;
+    uint64_t    driverHash_ = 0;
+    bool        enabled_ = false;
+    Stats       stats_;
+};
+
+// nullptr (the default) disables caching in CreateShader().
+void          SetProgramCache(ProgramCache* cache);
+ProgramCache* GetProgramCache();
+
+} // namespace GL
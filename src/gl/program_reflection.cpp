@@ -0,0 +1,233 @@
+#include "program_reflection.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+
+namespace {
+
+using Resource = GL::ProgramReflection::Resource;
+
+std::string GetResourceName(GLuint program, GLenum interface, GLuint index,
+                            GLint length)
+{
+    std::string name(std::max(length, 1), '\0');
+    glGetProgramResourceName(program, interface, index, length, nullptr,
+                             name.data());
+    name.resize(length > 0 ? length - 1 : 0); // without the terminator
+    // arrays are reported by their first element
+    if (name.ends_with("[0]")) {
+        name.resize(name.size() - 3);
+    }
+    return name;
+}
+
+// Uniforms and vertex inputs: type, location and array size.
+std::vector<Resource> EnumerateVariables(GLuint program, GLenum interface)
+{
+    static constexpr std::array<GLenum, 4> props
+        = { GL_NAME_LENGTH, GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE };
+
+    GLint count = 0;
+    glGetProgramInterfaceiv(program, interface, GL_ACTIVE_RESOURCES, &count);
+    std::vector<Resource> resources;
+    resources.reserve(count);
+    for (GLint i = 0; i < count; ++i) {
+        std::array<GLint, props.size()> values = {};
+        glGetProgramResourceiv(program, interface, i, (GLsizei)props.size(),
+                               props.data(), (GLsizei)values.size(), nullptr,
+                               values.data());
+        // block members and built-ins have no location
+        if (values[2] < 0) {
+            continue;
+        }
+        auto& resource = resources.emplace_back();
+        resource.name = GetResourceName(program, interface, i, values[0]);
+        resource.hash = GL::HashName(resource.name);
+        resource.type = (GLenum)values[1];
+        resource.location = values[2];
+        resource.arraySize = values[3];
+    }
+    return resources;
+}
+
+// Uniform and shader storage blocks: binding and size.
+std::vector<Resource> EnumerateBlocks(GLuint program, GLenum interface)
+{
+    static constexpr std::array<GLenum, 3> props
+        = { GL_NAME_LENGTH, GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+
+    GLint count = 0;
+    glGetProgramInterfaceiv(program, interface, GL_ACTIVE_RESOURCES, &count);
+    std::vector<Resource> resources(count);
+    for (GLint i = 0; i < count; ++i) {
+        std::array<GLint, props.size()> values = {};
+        glGetProgramResourceiv(program, interface, i, (GLsizei)props.size(),
+                               props.data(), (GLsizei)values.size(), nullptr,
+                               values.data());
+        auto& resource = resources[i];
+        resource.name = GetResourceName(program, interface, i, values[0]);
+        resource.hash = GL::HashName(resource.name);
+        resource.binding = values[1];
+        resource.dataSize = values[2];
+    }
+    return resources;
+}
+
+const Resource* Find(const std::vector<Resource>& resources, uint32_t hash)
+{
+    // a handful per program, a linear scan beats a map
+    for (const auto& resource : resources) {
+        if (resource.hash == hash) {
+            return &resource;
+        }
+    }
+    return nullptr;
+}
+
+void CheckCollisions(const std::vector<Resource>& resources)
+{
+    for (size_t i = 0; i < resources.size(); ++i) {
+        for (size_t j = i + 1; j < resources.size(); ++j) {
+            if (resources[i].hash == resources[j].hash) {
+                SPDLOG_ERROR("'{}' and '{}' have the same name hash",
+                             resources[i].name, resources[j].name);
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool GL::Detail::IsSamplerType(GLenum type)
+{
+    switch (type) {
+    case GL_SAMPLER_1D:
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_3D:
+    case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_1D_SHADOW:
+    case GL_SAMPLER_2D_SHADOW:
+    case GL_SAMPLER_CUBE_SHADOW:
+    case GL_SAMPLER_1D_ARRAY:
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_CUBE_MAP_ARRAY:
+    case GL_SAMPLER_1D_ARRAY_SHADOW:
+    case GL_SAMPLER_2D_ARRAY_SHADOW:
+    case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+    case GL_SAMPLER_2D_MULTISAMPLE:
+    case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_SAMPLER_2D_RECT:
+    case GL_SAMPLER_2D_RECT_SHADOW:
+    case GL_SAMPLER_BUFFER:
+    // integer samplers have no shadow variants
+    case GL_INT_SAMPLER_1D:
+    case GL_INT_SAMPLER_2D:
+    case GL_INT_SAMPLER_3D:
+    case GL_INT_SAMPLER_CUBE:
+    case GL_INT_SAMPLER_1D_ARRAY:
+    case GL_INT_SAMPLER_2D_ARRAY:
+    case GL_INT_SAMPLER_CUBE_MAP_ARRAY:
+    case GL_INT_SAMPLER_2D_MULTISAMPLE:
+    case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_INT_SAMPLER_2D_RECT:
+    case GL_INT_SAMPLER_BUFFER:
+    case GL_UNSIGNED_INT_SAMPLER_1D:
+    case GL_UNSIGNED_INT_SAMPLER_2D:
+    case GL_UNSIGNED_INT_SAMPLER_3D:
+    case GL_UNSIGNED_INT_SAMPLER_CUBE:
+    case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+    case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+    case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool GL::Detail::IsImageType(GLenum type)
+{
+    switch (type) {
+    case GL_IMAGE_1D:
+    case GL_IMAGE_2D:
+    case GL_IMAGE_3D:
+    case GL_IMAGE_CUBE:
+    case GL_IMAGE_1D_ARRAY:
+    case GL_IMAGE_2D_ARRAY:
+    case GL_IMAGE_CUBE_MAP_ARRAY:
+    case GL_IMAGE_2D_MULTISAMPLE:
+    case GL_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case GL_IMAGE_2D_RECT:
+    case GL_IMAGE_BUFFER:
+    case GL_INT_IMAGE_1D:
+    case GL_INT_IMAGE_2D:
+    case GL_INT_IMAGE_3D:
+    case GL_INT_IMAGE_CUBE:
+    case GL_INT_IMAGE_1D_ARRAY:
+    case GL_INT_IMAGE_2D_ARRAY:
+    case GL_INT_IMAGE_CUBE_MAP_ARRAY:
+    case GL_INT_IMAGE_2D_MULTISAMPLE:
+    case GL_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case GL_INT_IMAGE_2D_RECT:
+    case GL_INT_IMAGE_BUFFER:
+    case GL_UNSIGNED_INT_IMAGE_1D:
+    case GL_UNSIGNED_INT_IMAGE_2D:
+    case GL_UNSIGNED_INT_IMAGE_3D:
+    case GL_UNSIGNED_INT_IMAGE_CUBE:
+    case GL_UNSIGNED_INT_IMAGE_1D_ARRAY:
+    case GL_UNSIGNED_INT_IMAGE_2D_ARRAY:
+    case GL_UNSIGNED_INT_IMAGE_CUBE_MAP_ARRAY:
+    case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE:
+    case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case GL_UNSIGNED_INT_IMAGE_2D_RECT:
+    case GL_UNSIGNED_INT_IMAGE_BUFFER:
+        return true;
+    default:
+        return false;
+    }
+}
+
+GL::ProgramReflection::ProgramReflection(GLuint program)
+    : program_(program)
+{
+    uniforms_ = EnumerateVariables(program, GL_UNIFORM);
+    uniformBlocks_ = EnumerateBlocks(program, GL_UNIFORM_BLOCK);
+    storageBlocks_ = EnumerateBlocks(program, GL_SHADER_STORAGE_BLOCK);
+    inputs_ = EnumerateVariables(program, GL_PROGRAM_INPUT);
+    CheckCollisions(uniforms_);
+    CheckCollisions(uniformBlocks_);
+    CheckCollisions(storageBlocks_);
+    CheckCollisions(inputs_);
+}
+
+const Resource* GL::ProgramReflection::FindUniform(uint32_t hash) const
+{
+    return Find(uniforms_, hash);
+}
+
+const Resource* GL::ProgramReflection::FindUniformBlock(uint32_t hash) const
+{
+    return Find(uniformBlocks_, hash);
+}
+
+const Resource* GL::ProgramReflection::FindStorageBlock(uint32_t hash) const
+{
+    return Find(storageBlocks_, hash);
+}
+
+const Resource* GL::ProgramReflection::FindInput(uint32_t hash) const
+{
+    return Find(inputs_, hash);
+}
+
+void GL::ProgramReflection::LogTypeMismatch(const Resource& uniform) const
+{
+    SPDLOG_ERROR("uniform '{}' of program {} has GL type {:#x}, not the one "
+                 "it is set with",
+                 uniform.name, program_, uniform.type);
+}
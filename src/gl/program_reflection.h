@@ -0,0 +1,192 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GL {
+
+// FNV-1a of a resource name, constexpr so lookups of literals hash at
+// compile time: constexpr auto Proj = GL::HashName("proj");
+constexpr uint32_t HashName(std::string_view name)
+{
+    uint32_t hash = 0x811c9dc5u;
+    for (const char c : name) {
+        hash = (hash ^ (uint8_t)c) * 0x01000193u;
+    }
+    return hash;
+}
+
+// Value of sampler uniforms, the unit of glBindTextureUnit().
+struct TextureUnit
+{
+    GLint unit = 0;
+};
+
+// Value of image uniforms, the unit of glBindImageTexture().
+struct ImageUnit
+{
+    GLint unit = 0;
+};
+
+namespace Detail {
+// Every sampler*, isampler* and usampler* type, shadow samplers included.
+bool IsSamplerType(GLenum type);
+// Every image*, iimage* and uimage* type.
+bool IsImageType(GLenum type);
+
+// Maps a C++ type to the GLSL types it may be set on and the call that sets
+// it. Add a specialization for every new uniform type.
+template <typename T>
+struct UniformType;
+
+#define DEFINE_UNIFORM_TYPE(_TYPE, _GL_TYPE, _SET)                            \
+    template <>                                                               \
+    struct UniformType<_TYPE>                                                 \
+    {                                                                         \
+        static bool Accepts(GLenum type) { return type == _GL_TYPE; }         \
+        static void Set(GLuint program, GLint location, const _TYPE& value)   \
+        {                                                                     \
+            _SET;                                                             \
+        }                                                                     \
+    }
+
+DEFINE_UNIFORM_TYPE(float, GL_FLOAT,
+                    glProgramUniform1f(program, location, value));
+DEFINE_UNIFORM_TYPE(GLint, GL_INT,
+                    glProgramUniform1i(program, location, value));
+DEFINE_UNIFORM_TYPE(GLuint, GL_UNSIGNED_INT,
+                    glProgramUniform1ui(program, location, value));
+DEFINE_UNIFORM_TYPE(bool, GL_BOOL,
+                    glProgramUniform1i(program, location, value));
+DEFINE_UNIFORM_TYPE(glm::vec2, GL_FLOAT_VEC2,
+                    glProgramUniform2fv(program, location, 1, &value.x));
+DEFINE_UNIFORM_TYPE(glm::vec3, GL_FLOAT_VEC3,
+                    glProgramUniform3fv(program, location, 1, &value.x));
+DEFINE_UNIFORM_TYPE(glm::vec4, GL_FLOAT_VEC4,
+                    glProgramUniform4fv(program, location, 1, &value.x));
+DEFINE_UNIFORM_TYPE(glm::mat4, GL_FLOAT_MAT4,
+                    glProgramUniformMatrix4fv(program, location, 1, GL_FALSE,
+                                              &value[0].x));
+#undef DEFINE_UNIFORM_TYPE
+
+template <>
+struct UniformType<TextureUnit>
+{
+    static bool Accepts(GLenum type) { return IsSamplerType(type); }
+    static void Set(GLuint program, GLint location, const TextureUnit& value)
+    {
+        glProgramUniform1i(program, location, value.unit);
+    }
+};
+
+template <>
+struct UniformType<ImageUnit>
+{
+    static bool Accepts(GLenum type) { return IsImageType(type); }
+    static void Set(GLuint program, GLint location, const ImageUnit& value)
+    {
+        glProgramUniform1i(program, location, value.unit);
+    }
+};
+} // namespace Detail
+
+// A resolved uniform of one program. Set() is a single glProgramUniform*()
+// call, no lookups. An invalid handle (the uniform is inactive or of another
+// type) ignores Set().
+template <typename T>
+class Uniform
+{
+public:
+    Uniform() = default;
+    Uniform(GLuint program, GLint location)
+        : program_(program)
+        , location_(location)
+    {
+    }
+
+    bool  IsValid() const { return location_ >= 0; }
+    GLint GetLocation() const { return location_; }
+
+    void Set(const T& value) const
+    {
+        if (location_ >= 0) {
+            Detail::UniformType<T>::Set(program_, location_, value);
+        }
+    }
+
+private:
+    GLuint program_ = 0;
+    GLint  location_ = -1;
+};
+
+// Active uniforms, uniform blocks, shader storage blocks and vertex inputs
+// of a linked program, enumerated once through the program interface
+// queries. Lookups are by name hash and never call the driver.
+class ProgramReflection
+{
+public:
+    struct Resource
+    {
+        std::string name; // arrays without the "[0]"
+        uint32_t    hash = 0;
+        GLenum      type = GL_NONE;  // uniforms and inputs
+        GLint       location = -1;   // uniforms and inputs
+        GLint       arraySize = 1;   // uniforms and inputs
+        GLint       binding = -1;    // blocks
+        GLint       dataSize = 0;    // blocks, in bytes
+    };
+
+    ProgramReflection() = default;
+    explicit ProgramReflection(GLuint program);
+
+    GLuint GetProgram() const { return program_; }
+
+    const std::vector<Resource>& GetUniforms() const { return uniforms_; }
+    const std::vector<Resource>& GetUniformBlocks() const
+    {
+        return uniformBlocks_;
+    }
+    const std::vector<Resource>& GetStorageBlocks() const
+    {
+        return storageBlocks_;
+    }
+    const std::vector<Resource>& GetInputs() const { return inputs_; }
+
+    // nullptr if there is no such active resource
+    const Resource* FindUniform(uint32_t hash) const;
+    const Resource* FindUniformBlock(uint32_t hash) const;
+    const Resource* FindStorageBlock(uint32_t hash) const;
+    const Resource* FindInput(uint32_t hash) const;
+
+    // Invalid if the uniform is inactive, or (logged) of another type.
+    template <typename T>
+    Uniform<T> GetUniform(uint32_t hash) const
+    {
+        const auto* uniform = FindUniform(hash);
+        if (!uniform) {
+            return {};
+        }
+        if (!Detail::UniformType<T>::Accepts(uniform->type)) {
+            LogTypeMismatch(*uniform);
+            return {};
+        }
+        return Uniform<T>(program_, uniform->location);
+    }
+
+private:
+    void LogTypeMismatch(const Resource& uniform) const;
+
+private:
+    GLuint                program_ = 0;
+    std::vector<Resource> uniforms_;
+    std::vector<Resource> uniformBlocks_;
+    std::vector<Resource> storageBlocks_;
+    std::vector<Resource> inputs_;
+};
+
+} // namespace GL
@@ -0,0 +1,134 @@
+#include "render_target.h"
+#include "framework.h"
+
+#include <spdlog/spdlog.h>
+
+#include <cstring>
+
+GL::RenderTarget::RenderTarget(int width, int height)
+    : width_(width)
+    , height_(height)
+{
+    Create();
+}
+
+GL::RenderTarget::~RenderTarget() { Destroy(); }
+
+void GL::RenderTarget::Resize(int width, int height)
+{
+    if (width == width_ && height == height_) {
+        return;
+    }
+    Destroy();
+    width_ = width;
+    height_ = height;
+    Create();
+}
+
+void GL::RenderTarget::Bind()
+{
+    GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, fbo_.Get()));
+}
+
+void GL::RenderTarget::BlitTo(GLuint framebuffer, int width, int height)
+{
+    GL_CALL(glBlitNamedFramebuffer(fbo_.Get(), framebuffer, 0, 0, width_, height_,
+                                   0, 0, width, height, GL_COLOR_BUFFER_BIT,
+                                   GL_NEAREST));
+}
+
+void GL::RenderTarget::Create()
+{
+    const auto bytes = (int64_t)width_ * height_ * 4;
+    color_ = Renderbuffer::Create(nullptr);
+    glNamedRenderbufferStorage(color_.Get(), GL_RGBA8, width_, height_);
+    color_.SetBytes(bytes);
+    depthStencil_ = Renderbuffer::Create(nullptr);
+    glNamedRenderbufferStorage(depthStencil_.Get(), GL_DEPTH24_STENCIL8,
+                               width_, height_);
+    depthStencil_.SetBytes(bytes);
+
+    fbo_ = Framebuffer::Create(nullptr);
+    glNamedFramebufferRenderbuffer(fbo_.Get(), GL_COLOR_ATTACHMENT0,
+                                   GL_RENDERBUFFER, color_.Get());
+    glNamedFramebufferRenderbuffer(fbo_.Get(), GL_DEPTH_STENCIL_ATTACHMENT,
+                                   GL_RENDERBUFFER, depthStencil_.Get());
+    glNamedFramebufferReadBuffer(fbo_.Get(), GL_COLOR_ATTACHMENT0);
+    const auto status = glCheckNamedFramebufferStatus(fbo_.Get(),
+                                                      GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        SPDLOG_ERROR("render target {}x{} is incomplete: {:x}", width_,
+                     height_, status);
+    }
+}
+
+void GL::RenderTarget::Destroy()
+{
+    // a pending readback is dropped, its copy may still be running, so the
+    // objects are only queued for deletion
+    for (auto& readback : readbackRing_) {
+        if (readback.fence) {
+            glDeleteSync(readback.fence);
+        }
+        readback = {};
+    }
+    fbo_.Reset();
+    color_.Reset();
+    depthStencil_.Reset();
+}
+
+void GL::RenderTarget::Readback()
+{
+    CollectReadback();
+
+    auto& readback = readbackRing_[readbackIndex_];
+    if (!readback.pbo) {
+        // created on first use, targets that are only composited never
+        // need them
+        const auto size = (GLsizeiptr)width_ * height_ * 4;
+        readback.pbo = Buffer::Create(nullptr);
+        glNamedBufferStorage(readback.pbo.Get(), size, nullptr,
+                             GL_MAP_READ_BIT);
+        readback.pbo.SetBytes(size);
+    }
+    if (readback.fence) {
+        // the GPU is more than ReadbackLatency frames behind, reuse the slot
+        glDeleteSync(readback.fence);
+    }
+    // nothing else uses the pack buffer or a read framebuffer of its own,
+    // both are left at 0 instead of querying and restoring them
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_.Get());
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo.Get());
+    GL_CALL(glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE,
+                         nullptr));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readbackIndex_ = (readbackIndex_ + 1) % ReadbackLatency;
+}
+
+void GL::RenderTarget::CollectReadback()
+{
+    // the oldest readback is the one we are about to overwrite
+    auto& readback = readbackRing_[readbackIndex_];
+    if (!readback.fence) {
+        return;
+    }
+    GLint status = GL_UNSIGNALED;
+    glGetSynciv(readback.fence, GL_SYNC_STATUS, 1, nullptr, &status);
+    if (status != GL_SIGNALED) {
+        return;
+    }
+    glDeleteSync(readback.fence);
+    readback.fence = nullptr;
+
+    const auto size = (size_t)width_ * height_ * 4;
+    const auto* data = glMapNamedBufferRange(readback.pbo.Get(), 0, size,
+                                             GL_MAP_READ_BIT);
+    if (data) {
+        pixels_.resize(size);
+        std::memcpy(pixels_.data(), data, size);
+        glUnmapNamedBuffer(readback.pbo.Get());
+        ++readbacks_;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "framework.h"
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace GL {
+
+// Offscreen RGBA8 color + depth/stencil framebuffer with an optional
+// asynchronous readback through a small ring of pixel pack buffers. Resizing
+// releases the old objects through the DeletionQueue, frames in flight may
+// still render into or read from them.
+class RenderTarget
+{
+public:
+    static constexpr size_t ReadbackLatency = 3;
+
+    RenderTarget(int width, int height);
+    ~RenderTarget();
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget(RenderTarget&&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+    RenderTarget& operator=(RenderTarget&&) = delete;
+
+    void   Resize(int width, int height);
+    void   Bind();
+    GLuint GetFramebuffer() const { return fbo_.Get(); }
+    int    GetWidth() const { return width_; }
+    int    GetHeight() const { return height_; }
+
+    // Copies the color buffer into framebuffer (0 - the window's back
+    // buffer), stretched to width x height.
+    void BlitTo(GLuint framebuffer, int width, int height);
+
+    // Queues a copy of the color buffer and collects the oldest one whose
+    // fence has already signaled, without ever waiting for the GPU.
+    void Readback();
+    // Pixels of the last collected readback, bottom-up RGBA8 rows.
+    const std::vector<uint8_t>& GetPixels() const { return pixels_; }
+    uint64_t GetReadbackCount() const { return readbacks_; }
+
+private:
+    void Create();
+    void Destroy();
+    void CollectReadback();
+
+private:
+    struct PendingReadback
+    {
+        Buffer pbo;
+        GLsync fence = nullptr;
+    };
+
+    int          width_;
+    int          height_;
+    Framebuffer  fbo_;
+    Renderbuffer color_;
+    Renderbuffer depthStencil_;
+
+    std::array<PendingReadback, ReadbackLatency> readbackRing_ = {};
+    size_t               readbackIndex_ = 0;
+    std::vector<uint8_t> pixels_;
+    uint64_t             readbacks_ = 0;
+};
+
+} // namespace GL
@@ -0,0 +1,168 @@
+#include "shader_library.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+GL::ShaderProgram::ShaderProgram(std::string vertexFile,
+                                 std::string fragmentFile)
+    : vertexFile_(std::move(vertexFile))
+    , fragmentFile_(std::move(fragmentFile))
+{
+}
+
+GL::ShaderLibrary::ShaderLibrary(std::string directory, bool watch)
+    : directory_(std::move(directory))
+{
+    if (!watch) {
+        return;
+    }
+#ifdef __linux__
+    watchFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // editors either rewrite the file or rename a new one over it
+    if (watchFd_ >= 0
+        && inotify_add_watch(watchFd_, directory_.c_str(),
+                             IN_CLOSE_WRITE | IN_MOVED_TO)
+            < 0) {
+        close(watchFd_);
+        watchFd_ = -1;
+    }
+    if (watchFd_ < 0) {
+        SPDLOG_ERROR("could not watch '{}' for shader changes", directory_);
+    }
+#else
+    SPDLOG_INFO("shader hot reload is only supported on Linux");
+#endif
+}
+
+GL::ShaderLibrary::~ShaderLibrary()
+{
+#ifdef __linux__
+    if (watchFd_ >= 0) {
+        close(watchFd_);
+    }
+#endif
+}
+
+GL::ShaderProgram* GL::ShaderLibrary::Load(const std::string& vertexFile,
+                                           const std::string& fragmentFile)
+{
+    for (const auto& program : programs_) {
+        if (program->vertexFile_ == vertexFile
+            && program->fragmentFile_ == fragmentFile) {
+            return program.get();
+        }
+    }
+
+    auto& program = programs_.emplace_back(
+        new ShaderProgram(vertexFile, fragmentFile));
+    Build(*program);
+    return program.get();
+}
+
+bool GL::ShaderLibrary::CheckFiles()
+{
+#ifdef __linux__
+    if (watchFd_ >= 0) {
+        alignas(inotify_event) char buffer[4096];
+        ssize_t size;
+        while ((size = read(watchFd_, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t offset = 0; offset < size;) {
+                const auto* event = (const inotify_event*)(buffer + offset);
+                if (event->len > 0) {
+                    changedFiles_.emplace_back(event->name);
+                }
+                offset += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+#endif
+    return !changedFiles_.empty() || HasPending();
+}
+
+bool GL::ShaderLibrary::Poll()
+{
+    // a file saved several times since the last poll is rebuilt once
+    if (!changedFiles_.empty()) {
+        const auto isChanged = [this](const std::string& file) {
+            return std::find(changedFiles_.begin(), changedFiles_.end(), file)
+                != changedFiles_.end();
+        };
+        for (auto& program : programs_) {
+            if (isChanged(program->vertexFile_)
+                || isChanged(program->fragmentFile_)) {
+                SPDLOG_INFO("rebuilding {} + {}", program->vertexFile_,
+                            program->fragmentFile_);
+                Build(*program);
+            }
+        }
+        changedFiles_.clear();
+    }
+
+    bool changed = false;
+    for (auto& program : programs_) {
+        auto& pending = program->pending_;
+        if (pending.IsEmpty()) {
+            continue;
+        }
+        if (pending.IsReady()) {
+            program->program_ = Program(pending.Release(), this);
+            program->reflection_ = ProgramReflection(program->program_.Get());
+            program->version_++;
+            program->failed_ = false;
+            changed = true;
+        } else if (pending.IsFailed()) {
+            SPDLOG_ERROR("{} + {} failed to build{}", program->vertexFile_,
+                         program->fragmentFile_,
+                         program->program_ ? ", keeping the last good one" : "");
+            pending = PendingProgram();
+            program->failed_ = true;
+        }
+    }
+    return changed;
+}
+
+bool GL::ShaderLibrary::HasPending() const
+{
+    return std::any_of(programs_.begin(), programs_.end(),
+                       [](const auto& program) {
+                           return program->IsPending();
+                       });
+}
+
+bool GL::ShaderLibrary::Build(ShaderProgram& program)
+{
+    std::string vertexShader, fragmentShader;
+    if (!ReadFile(program.vertexFile_, vertexShader)
+        || !ReadFile(program.fragmentFile_, fragmentShader)) {
+        program.failed_ = true;
+        return false;
+    }
+    // replaces a build still in flight, its sources are stale
+    program.pending_
+        = PendingProgram(vertexShader.c_str(), fragmentShader.c_str());
+    return true;
+}
+
+bool GL::ShaderLibrary::ReadFile(const std::string& file,
+                                 std::string&       source) const
+{
+    const auto    path = std::filesystem::path(directory_) / file;
+    std::ifstream stream(path);
+    if (!stream) {
+        SPDLOG_ERROR("could not read shader '{}'", path.string());
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << stream.rdbuf();
+    source = buffer.str();
+    return true;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "framework.h"
+#include "program_reflection.h"
+
+#include <glad/glad.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace GL {
+
+// A program built from a vertex and a fragment shader file of a
+// ShaderLibrary. Get() returns the last build that linked: a rebuild
+// replaces it only once it has linked, a failed one leaves it in place.
+class ShaderProgram
+{
+public:
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram(ShaderProgram&&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(ShaderProgram&&) = delete;
+
+    // 0 until the first build has linked.
+    GLuint Get() const { return program_.Get(); }
+    bool   IsPending() const { return !pending_.IsEmpty(); }
+    // The latest build failed, its log has been printed.
+    bool IsFailed() const { return failed_; }
+
+    // Of the program Get() returns. Uniform handles resolved from it stay
+    // valid until the version changes, a reload has to resolve them again.
+    const ProgramReflection& GetReflection() const { return reflection_; }
+    uint64_t                 GetVersion() const { return version_; }
+
+private:
+    friend class ShaderLibrary;
+    ShaderProgram(std::string vertexFile, std::string fragmentFile);
+
+private:
+    std::string    vertexFile_;
+    std::string    fragmentFile_;
+    Program           program_;
+    ProgramReflection reflection_;
+    uint64_t          version_ = 0;
+    PendingProgram    pending_;
+    bool              failed_ = false;
+};
+
+// Loads shader sources from files in a directory and, with watching on
+// (inotify, Linux only), rebuilds the programs whose files changed. Builds
+// go through PendingProgram, so they compile in the background with
+// parallel shader compile; finished ones are swapped in by Poll(), which
+// the app calls between frames, so a frame never sees two versions of a
+// program; replaced programs go through the DeletionQueue, frames still in
+// flight keep drawing with them. Programs stay loaded until the library is
+// destroyed, reopening a canvas reuses its programs. They are counted in
+// the ResourceStats of the library.
+class ShaderLibrary
+{
+public:
+    ShaderLibrary(std::string directory, bool watch);
+    ~ShaderLibrary();
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary(ShaderLibrary&&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(ShaderLibrary&&) = delete;
+
+    // File names are relative to the directory. Starts the first build, the
+    // program is owned by the library. Needs the GL context.
+    ShaderProgram* Load(const std::string& vertexFile,
+                        const std::string& fragmentFile);
+
+    // Reads file change notifications without touching GL, true if Poll()
+    // has work to do.
+    bool CheckFiles();
+    // Starts rebuilds of changed programs and swaps in the finished ones,
+    // true if any program changed. Needs the GL context.
+    bool Poll();
+
+    // Builds in flight, Poll() has to be called again to finish them.
+    bool HasPending() const;
+    bool IsWatching() const { return watchFd_ >= 0; }
+
+private:
+    bool Build(ShaderProgram& program);
+    bool ReadFile(const std::string& file, std::string& source) const;
+
+private:
+    std::string                                 directory_;
+    std::vector<std::unique_ptr<ShaderProgram>> programs_;
+    std::vector<std::string>                    changedFiles_;
+    int                                         watchFd_ = -1;
+};
+
+} // namespace GL
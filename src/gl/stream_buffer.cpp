@@ -0,0 +1,69 @@
+#include "stream_buffer.h"
+#include "framework.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+GL::StreamBuffer::StreamBuffer(GLsizeiptr regionSize, uint32_t regions)
+    : regionSize_(regionSize)
+    , regions_(std::max<uint32_t>(regions, 1))
+{
+    Create();
+}
+
+GL::StreamBuffer::~StreamBuffer() { Destroy(); }
+
+void GL::StreamBuffer::Create()
+{
+    static constexpr GLbitfield flags
+        = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    buffer_ = Buffer::Create(nullptr);
+    GL_CALL(glNamedBufferStorage(buffer_.Get(), regionSize_ * regions_,
+                                 nullptr, flags));
+    buffer_.SetBytes(regionSize_ * regions_);
+    mapping_ = (uint8_t*)glMapNamedBufferRange(
+        buffer_.Get(), 0, regionSize_ * regions_, flags);
+    if (!mapping_) {
+        SPDLOG_ERROR("could not map a stream buffer of {} bytes",
+                     regionSize_ * regions_);
+    }
+}
+
+void GL::StreamBuffer::Destroy()
+{
+    // deleting unmaps it, which the queue only does once the frames that
+    // may still write or read the mapping have finished
+    buffer_.Reset();
+    mapping_ = nullptr;
+}
+
+void GL::StreamBuffer::BeginFrame(uint32_t frameIndex)
+{
+    region_ = frameIndex % regions_;
+    cursor_ = 0;
+}
+
+GL::StreamBuffer::Allocation GL::StreamBuffer::Allocate(GLsizeiptr size,
+                                                        GLsizeiptr alignment)
+{
+    auto offset = (cursor_ + alignment - 1) / alignment * alignment;
+    if (offset + size > regionSize_) {
+        // The regions of a new buffer are not used by any frame in flight,
+        // so the rest of this frame can continue in it right away.
+        while (regionSize_ < size) {
+            regionSize_ *= 2;
+        }
+        regionSize_ *= 2;
+        Destroy();
+        Create();
+        ++grows_;
+        SPDLOG_INFO("stream buffer grown to {} bytes per frame", regionSize_);
+        offset = 0;
+    }
+    cursor_ = offset + size;
+
+    const auto bufferOffset = region_ * regionSize_ + offset;
+    return {bufferOffset, mapping_ + bufferOffset};
+}
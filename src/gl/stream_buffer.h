@@ -0,0 +1,58 @@
+#pragma once
+
+#include "framework.h"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+namespace GL {
+
+// Persistently mapped, coherent buffer split into one region per frame in
+// flight (see FrameFences). A frame sub-allocates linearly from its region
+// and memcpy's straight into the mapping; the region is only reused once the
+// frame's fence has signaled, so writes never wait for or race the GPU.
+class StreamBuffer
+{
+public:
+    struct Allocation
+    {
+        GLintptr offset = 0; // into GetBuffer()
+        void*    data = nullptr;
+    };
+
+    StreamBuffer(GLsizeiptr regionSize, uint32_t regions);
+    ~StreamBuffer();
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer(StreamBuffer&&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(StreamBuffer&&) = delete;
+
+    // frameIndex as returned by FrameFences::GetFrameIndex()
+    void BeginFrame(uint32_t frameIndex);
+
+    // Never fails. A region that is too small is replaced by a new buffer
+    // with larger regions, which changes GetBuffer(). The old buffer goes
+    // through the DeletionQueue and stays mapped until then, so allocations
+    // made before the growth remain valid for the rest of their frame.
+    Allocation Allocate(GLsizeiptr size, GLsizeiptr alignment = 4);
+
+    GLuint     GetBuffer() const { return buffer_.Get(); }
+    GLsizeiptr GetRegionSize() const { return regionSize_; }
+    uint64_t   GetGrowCount() const { return grows_; }
+
+private:
+    void Create();
+    void Destroy();
+
+private:
+    GLsizeiptr regionSize_;
+    uint32_t   regions_;
+    uint32_t   region_ = 0;
+    GLsizeiptr cursor_ = 0; // within the region
+    Buffer     buffer_;
+    uint8_t*   mapping_ = nullptr;
+    uint64_t   grows_ = 0;
+};
+
+} // namespace GL
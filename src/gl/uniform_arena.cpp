@@ -0,0 +1,24 @@
+#include "uniform_arena.h"
+
+#include <algorithm>
+
+namespace {
+GL::UniformArena* g_uniformArena = nullptr;
+} // namespace
+
+GL::UniformArena::UniformArena(GLsizeiptr regionSize, uint32_t framesInFlight)
+    : stream_(regionSize, framesInFlight)
+{
+    GLint uniformAlignment = 0, storageAlignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+    if (uniformAlignment > 0) {
+        uniformAlignment_ = uniformAlignment;
+    }
+    // both are powers of two, the larger one satisfies either
+    alignment_ = std::max<GLsizeiptr>({uniformAlignment_, storageAlignment, 4});
+}
+
+void GL::SetUniformArena(UniformArena* arena) { g_uniformArena = arena; }
+
+GL::UniformArena* GL::GetUniformArena() { return g_uniformArena; }
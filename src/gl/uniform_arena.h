@@ -0,0 +1,122 @@
+#pragma once
+
+#include "framework.h"
+#include "stream_buffer.h"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+namespace GL {
+
+// Per frame constants of every canvas. Blocks are written straight into a
+// StreamBuffer, which is the whole upload, and bound with
+// glBindBufferRange() instead of one glUniform*() per value. Allocations
+// are only valid for the frame they were made in, call Allocate*() while
+// recording the draws that read them. A later allocation that grows the
+// arena does not invalidate them, the old buffer is kept until the frame
+// has finished. Check the structs with CheckLayout() (see block_layout.h).
+class UniformArena
+{
+public:
+    // count blocks of T, written through operator[]
+    template <typename T>
+    class Blocks
+    {
+    public:
+        Blocks() = default;
+        Blocks(GLuint buffer, GLintptr offset, GLsizeiptr stride, void* data,
+               uint32_t count)
+            : buffer_(buffer)
+            , offset_(offset)
+            , stride_(stride)
+            , data_((uint8_t*)data)
+            , count_(count)
+        {
+        }
+
+        T& operator[](uint32_t index) const
+        {
+            return *(T*)(data_ + index * stride_);
+        }
+        uint32_t GetCount() const { return count_; }
+
+        // One block as a uniform block, only for AllocateUniforms().
+        void BindUniform(GLuint binding, uint32_t index) const;
+        // All blocks as the array of a shader storage block, only for
+        // AllocateStorage().
+        void BindStorage(GLuint binding) const;
+
+    private:
+        GLuint     buffer_ = 0;
+        GLintptr   offset_ = 0;
+        GLsizeiptr stride_ = 0;
+        uint8_t*   data_ = nullptr;
+        uint32_t   count_ = 0;
+    };
+
+    UniformArena(GLsizeiptr regionSize, uint32_t framesInFlight);
+    UniformArena(const UniformArena&) = delete;
+    UniformArena(UniformArena&&) = delete;
+    UniformArena& operator=(const UniformArena&) = delete;
+    UniformArena& operator=(UniformArena&&) = delete;
+
+    // frameIndex as returned by FrameFences::GetFrameIndex()
+    void BeginFrame(uint32_t frameIndex) { stream_.BeginFrame(frameIndex); }
+
+    // Every block starts at GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, so each can
+    // be bound on its own, e.g. one per draw.
+    template <typename T>
+    Blocks<T> AllocateUniforms(uint32_t count)
+    {
+        return Allocate<T>(count, AlignUp(sizeof(T), uniformAlignment_));
+    }
+    // Tightly packed, indexed in the shader by draw or instance ID.
+    template <typename T>
+    Blocks<T> AllocateStorage(uint32_t count)
+    {
+        return Allocate<T>(count, sizeof(T));
+    }
+
+    uint64_t GetGrowCount() const { return stream_.GetGrowCount(); }
+
+private:
+    template <typename T>
+    Blocks<T> Allocate(uint32_t count, GLsizeiptr stride)
+    {
+        const auto allocation = stream_.Allocate(stride * count, alignment_);
+        return Blocks<T>(stream_.GetBuffer(), allocation.offset, stride,
+                         allocation.data, count);
+    }
+
+    static GLsizeiptr AlignUp(GLsizeiptr value, GLsizeiptr alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+private:
+    StreamBuffer stream_;
+    GLsizeiptr   uniformAlignment_ = 256;
+    GLsizeiptr   alignment_ = 256; // of uniform and storage blocks
+};
+
+// The arena of the render context, nullptr before the renderer is up.
+void          SetUniformArena(UniformArena* arena);
+UniformArena* GetUniformArena();
+
+template <typename T>
+void UniformArena::Blocks<T>::BindUniform(GLuint binding,
+                                          uint32_t index) const
+{
+    GetStateCache().BindBufferRange(GL_UNIFORM_BUFFER, binding, buffer_,
+                                    offset_ + index * stride_, sizeof(T));
+}
+
+template <typename T>
+void UniformArena::Blocks<T>::BindStorage(GLuint binding) const
+{
+    GetStateCache().BindBufferRange(GL_SHADER_STORAGE_BUFFER, binding,
+                                    buffer_, offset_, stride_ * count_);
+}
+
+} // namespace GL
@@ -0,0 +1,253 @@
+#include "upload_service.h"
+#include "framework.h"
+
+#include <SDL3/SDL.h>
+#include <spdlog/spdlog.h>
+#include <stb_image.h>
+
+#include <array>
+
+GL::UploadService::UploadService()
+{
+    auto* lastWindow = SDL_GL_GetCurrentWindow();
+    auto* lastContext = SDL_GL_GetCurrentContext();
+
+    // 8x8 checkerboard, created on the render context so it is usable
+    // right away
+    std::array<uint32_t, 64> checker;
+    for (size_t i = 0; i < checker.size(); ++i) {
+        checker[i] = ((i / 8 + i % 8) % 2) ? 0xFF808080u : 0xFFC0C0C0u;
+    }
+    glCreateTextures(GL_TEXTURE_2D, 1, &placeholder_);
+    glTextureStorage2D(placeholder_, 1, GL_RGBA8, 8, 8);
+    glTextureSubImage2D(placeholder_, 0, 0, 0, 8, 8, GL_RGBA, GL_UNSIGNED_BYTE,
+                        checker.data());
+    glTextureParameteri(placeholder_, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(placeholder_, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    window_ = SDL_CreateWindow("upload window", 1, 1,
+                               SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    if (window_) {
+        SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+        context_ = SDL_GL_CreateContext(window_);
+        SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    }
+    if (!context_) {
+        SPDLOG_ERROR("could not create the upload context: {}",
+                     SDL_GetError());
+    }
+
+    // SDL_GL_CreateContext makes the new context current
+    SDL_GL_MakeCurrent(lastWindow, lastContext);
+    thread_ = std::thread(&UploadService::WorkerMain, this);
+}
+
+GL::UploadService::~UploadService()
+{
+    {
+        std::lock_guard lock(mutex_);
+        quit_ = true;
+        jobs_.clear();
+    }
+    wake_.notify_one();
+    thread_.join();
+
+    for (auto& finished : finished_) {
+        glDeleteSync(finished.fence);
+        Delete(finished);
+    }
+    glDeleteTextures(1, &placeholder_);
+    if (context_) {
+        SDL_GL_DestroyContext(context_);
+    }
+    if (window_) {
+        SDL_DestroyWindow(window_);
+    }
+}
+
+GL::UploadService::Ticket
+GL::UploadService::LoadTexture(TextureRequest request, TextureCallback callback)
+{
+    std::lock_guard lock(mutex_);
+    Job             job;
+    job.ticket = nextTicket_++;
+    job.texture = std::move(request);
+    job.onTexture = std::move(callback);
+    jobs_.push_back(std::move(job));
+    wake_.notify_one();
+    return jobs_.back().ticket;
+}
+
+GL::UploadService::Ticket
+GL::UploadService::UploadBuffer(std::vector<uint8_t> data, GLbitfield flags,
+                                BufferCallback callback)
+{
+    std::lock_guard lock(mutex_);
+    Job             job;
+    job.ticket = nextTicket_++;
+    job.data = std::move(data);
+    job.flags = flags;
+    job.onBuffer = std::move(callback);
+    jobs_.push_back(std::move(job));
+    wake_.notify_one();
+    return jobs_.back().ticket;
+}
+
+void GL::UploadService::Cancel(Ticket ticket)
+{
+    if (!ticket) {
+        return;
+    }
+    std::lock_guard lock(mutex_);
+    canceled_.insert(ticket);
+}
+
+bool GL::UploadService::HasPending() const
+{
+    std::lock_guard lock(mutex_);
+    return !jobs_.empty() || running_ || !finished_.empty();
+}
+
+void GL::UploadService::Poll()
+{
+    std::vector<Finished> ready;
+    {
+        std::lock_guard lock(mutex_);
+        for (size_t i = 0; i < finished_.size();) {
+            GLint status = GL_UNSIGNALED;
+            glGetSynciv(finished_[i].fence, GL_SYNC_STATUS, 1, nullptr,
+                        &status);
+            if (status != GL_SIGNALED) {
+                ++i;
+                continue;
+            }
+            ready.push_back(std::move(finished_[i]));
+            finished_.erase(finished_.begin() + i);
+        }
+    }
+
+    for (auto& finished : ready) {
+        glDeleteSync(finished.fence);
+
+        bool canceled = false;
+        {
+            std::lock_guard lock(mutex_);
+            canceled = canceled_.erase(finished.ticket) > 0;
+        }
+        if (canceled) {
+            Delete(finished);
+        } else if (finished.onTexture) {
+            finished.onTexture(finished.texture);
+        } else if (finished.onBuffer) {
+            finished.onBuffer(finished.buffer);
+        }
+    }
+}
+
+void GL::UploadService::WorkerMain()
+{
+    if (!context_ || !SDL_GL_MakeCurrent(window_, context_)) {
+        SPDLOG_ERROR("upload context is unusable, uploads will never finish");
+        return;
+    }
+
+    std::unique_lock lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return quit_ || !jobs_.empty(); });
+        if (quit_) {
+            break;
+        }
+        auto job = std::move(jobs_.front());
+        jobs_.pop_front();
+        if (canceled_.erase(job.ticket)) {
+            continue;
+        }
+        ++running_;
+        lock.unlock();
+
+        Finished finished;
+        finished.ticket = job.ticket;
+        finished.onTexture = std::move(job.onTexture);
+        finished.onBuffer = std::move(job.onBuffer);
+        if (finished.onTexture) {
+            RunTextureJob(job, finished);
+        } else {
+            RunBufferJob(job, finished);
+        }
+        // the fence has to reach the GPU before another context waits on it
+        finished.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        lock.lock();
+        --running_;
+        finished_.push_back(std::move(finished));
+    }
+    lock.unlock();
+
+    SDL_GL_MakeCurrent(nullptr, nullptr);
+}
+
+void GL::UploadService::RunTextureJob(Job& job, Finished& finished)
+{
+    const auto& request = job.texture;
+    auto&       result = finished.texture;
+
+    stbi_set_flip_vertically_on_load_thread(request.flipVertically);
+    auto* data = stbi_load(request.path.c_str(), &result.width,
+                           &result.height, &result.channels, 0);
+    if (!data) {
+        SPDLOG_ERROR("Failed to load texture {}: {}", request.path,
+                     stbi_failure_reason());
+        result = {};
+        return;
+    }
+
+    GLenum format = GL_RGB;
+    if (result.channels == 1)
+        format = GL_RED;
+    else if (result.channels == 2)
+        format = GL_RG;
+    else if (result.channels == 4)
+        format = GL_RGBA;
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &result.texture);
+    glTextureParameteri(result.texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(result.texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTextureParameteri(result.texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(result.texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // glTexImage2D lets the driver compress to generic formats as well,
+    // immutable storage would only accept specific ones
+    glBindTexture(GL_TEXTURE_2D, result.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0,
+                         request.internalFormat == GL_NONE
+                             ? format
+                             : request.internalFormat,
+                         result.width, result.height, 0, format,
+                         GL_UNSIGNED_BYTE, data));
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED_IMAGE_SIZE,
+                             &result.compressedSize);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    stbi_image_free(data);
+}
+
+void GL::UploadService::RunBufferJob(Job& job, Finished& finished)
+{
+    auto& result = finished.buffer;
+    result.size = (GLsizeiptr)job.data.size();
+    glCreateBuffers(1, &result.buffer);
+    glNamedBufferStorage(result.buffer, result.size, job.data.data(),
+                         job.flags);
+}
+
+void GL::UploadService::Delete(const Finished& finished)
+{
+    if (finished.texture.texture) {
+        glDeleteTextures(1, &finished.texture.texture);
+    }
+    if (finished.buffer.buffer) {
+        glDeleteBuffers(1, &finished.buffer.buffer);
+    }
+}
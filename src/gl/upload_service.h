@@ -0,0 +1,123 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+struct SDL_Window;
+struct SDL_GLContextState;
+
+namespace GL {
+
+// Creates textures and buffers on a worker thread with its own GL context
+// that shares objects with the render context. Decoding and uploading
+// (including driver-side compression) never block a frame: every upload
+// ends with a fence, and Poll() hands an object out only after its fence
+// has signaled, so the render context never sees a half-written object.
+class UploadService
+{
+public:
+    using Ticket = uint64_t;
+
+    struct TextureRequest
+    {
+        std::string path;
+        GLenum      internalFormat = GL_NONE; // GL_NONE - match the image
+        bool        flipVertically = true;
+    };
+
+    struct TextureResult
+    {
+        GLuint texture = 0; // 0 if the image could not be loaded
+        int    width = 0;
+        int    height = 0;
+        int    channels = 0;
+        GLint  compressedSize = 0;
+    };
+
+    struct BufferResult
+    {
+        GLuint     buffer = 0;
+        GLsizeiptr size = 0;
+    };
+
+    using TextureCallback = std::function<void(const TextureResult&)>;
+    using BufferCallback = std::function<void(const BufferResult&)>;
+
+    // Must be called with the render context current, the shared context is
+    // created on an own hidden window.
+    UploadService();
+    ~UploadService();
+    UploadService(const UploadService&) = delete;
+    UploadService(UploadService&&) = delete;
+    UploadService& operator=(const UploadService&) = delete;
+    UploadService& operator=(UploadService&&) = delete;
+
+    // Callbacks run inside Poll(), the result's object is owned by the
+    // callback from then on.
+    Ticket LoadTexture(TextureRequest request, TextureCallback callback);
+    Ticket UploadBuffer(std::vector<uint8_t> data, GLbitfield flags,
+                        BufferCallback callback);
+    // The callback is dropped, the object is deleted or never created.
+    // Ticket 0 is never issued and is ignored.
+    void Cancel(Ticket ticket);
+
+    // Delivers finished uploads, render context only.
+    void Poll();
+    bool HasPending() const;
+
+    // Small checkerboard to show while a texture is loading.
+    GLuint GetPlaceholderTexture() const { return placeholder_; }
+
+private:
+    struct Job
+    {
+        Ticket                ticket;
+        TextureRequest        texture;
+        std::vector<uint8_t>  data; // buffer jobs only
+        GLbitfield            flags = 0;
+        TextureCallback       onTexture;
+        BufferCallback        onBuffer;
+    };
+
+    struct Finished
+    {
+        Ticket          ticket;
+        GLsync          fence;
+        TextureResult   texture;
+        BufferResult    buffer;
+        TextureCallback onTexture;
+        BufferCallback  onBuffer;
+    };
+
+    void WorkerMain();
+    void RunTextureJob(Job& job, Finished& finished);
+    void RunBufferJob(Job& job, Finished& finished);
+    static void Delete(const Finished& finished);
+
+private:
+    SDL_Window*         window_ = nullptr;
+    SDL_GLContextState* context_ = nullptr;
+    GLuint              placeholder_ = 0;
+
+    mutable std::mutex         mutex_;
+    std::condition_variable    wake_;
+    bool                       quit_ = false;
+    Ticket                     nextTicket_ = 1;
+    std::deque<Job>            jobs_;
+    std::vector<Finished>      finished_;
+    std::unordered_set<Ticket> canceled_;
+    size_t                     running_ = 0;
+
+    std::thread thread_;
+};
+
+} // namespace GL
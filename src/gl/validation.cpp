@@ -0,0 +1,268 @@
+#include "validation.h"
+
+#include <glad/glad.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <format>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+struct CallSite
+{
+    const char* call = nullptr;
+    const char* file = nullptr;
+    int         line = 0;
+};
+
+std::atomic<GL::Validation> g_validation = GL::Validation::Off; // the app's
+
+// Debug output state of the render context, only touched by the thread
+// that holds it.
+GL::Validation g_active = GL::Validation::Off;
+bool           g_callbackInstalled = false;
+bool           g_unsupportedLogged = false;
+
+// Raised by a ValidationScope for the calls of its own thread, so a canvas
+// neither checks nor is blamed for the calls of the upload thread. An
+// asynchronous callback may run on a driver thread and then names no scope.
+thread_local GL::Validation g_scope = GL::Validation::Off;
+thread_local const char*    g_scopeName = nullptr;
+thread_local CallSite       g_callSite;
+
+std::mutex                             g_messagesMutex;
+std::unordered_map<uint64_t, uint64_t> g_messageCounts;
+GL::ValidationStats                    g_stats;
+
+const char* GetSourceName(GLenum source)
+{
+    switch (source) {
+    case GL_DEBUG_SOURCE_API:
+        return "api";
+    case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+        return "window system";
+    case GL_DEBUG_SOURCE_SHADER_COMPILER:
+        return "shader compiler";
+    case GL_DEBUG_SOURCE_THIRD_PARTY:
+        return "third party";
+    case GL_DEBUG_SOURCE_APPLICATION:
+        return "application";
+    default:
+        return "other";
+    }
+}
+
+const char* GetTypeName(GLenum type)
+{
+    switch (type) {
+    case GL_DEBUG_TYPE_ERROR:
+        return "error";
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+        return "deprecated";
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+        return "undefined behavior";
+    case GL_DEBUG_TYPE_PORTABILITY:
+        return "portability";
+    case GL_DEBUG_TYPE_PERFORMANCE:
+        return "performance";
+    default:
+        return "other";
+    }
+}
+
+// FNV-1a of what identifies a message, the text included: some drivers use
+// one id for many different messages.
+uint64_t HashMessage(GLenum source, GLenum type, GLuint id,
+                     std::string_view message)
+{
+    uint64_t   hash = 0xcbf29ce484222325ull;
+    const auto add = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 0x100000001b3ull;
+    };
+    add(source);
+    add(type);
+    add(id);
+    for (const char c : message) {
+        add((uint8_t)c);
+    }
+    return hash;
+}
+
+// The first occurrence and then every power of ten, so a message repeated
+// on every frame neither floods the log nor goes quiet.
+bool CountMessage(uint64_t hash, uint64_t& count)
+{
+    std::lock_guard lock(g_messagesMutex);
+    count = ++g_messageCounts[hash];
+    for (uint64_t logged = 1; logged <= count; logged *= 10) {
+        if (logged == count) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void APIENTRY OnDebugMessage(GLenum source, GLenum type, GLuint id,
+                             GLenum severity, GLsizei length,
+                             const GLchar* message, const void*)
+{
+    const std::string_view text = length >= 0
+        ? std::string_view(message, length)
+        : std::string_view(message);
+
+    uint64_t count = 1;
+    if (!CountMessage(HashMessage(source, type, id, text), count)) {
+        g_stats.duplicates++;
+        return;
+    }
+    g_stats.messages++;
+
+    const auto level = type == GL_DEBUG_TYPE_ERROR
+            || severity == GL_DEBUG_SEVERITY_HIGH
+        ? spdlog::level::err
+        : severity == GL_DEBUG_SEVERITY_MEDIUM ? spdlog::level::warn
+                                               : spdlog::level::info;
+    const auto* scope = g_scopeName;
+    // set only while a GL_CALL of this thread runs, so only synchronous
+    // messages are attributed to a call
+    const auto& site = g_callSite;
+    spdlog::log(level, "GL {} {} {:#x}: {}{}{}{}", GetSourceName(source),
+                GetTypeName(type), id, text,
+                site.call ? std::format(" [{} at {}:{}]", site.call,
+                                        site.file, site.line)
+                          : "",
+                scope ? std::format(" in {}", scope) : "",
+                count > 1 ? std::format(" (x{})", count) : "");
+}
+
+void Apply(GL::Validation validation)
+{
+    if (validation == g_active) {
+        return;
+    }
+    g_active = validation;
+
+    if (!glDebugMessageCallback) {
+        if (validation != GL::Validation::Off && !g_unsupportedLogged) {
+            g_unsupportedLogged = true;
+            SPDLOG_INFO("no KHR_debug, GL validation is limited to GL_CALL");
+        }
+        return;
+    }
+    if (!g_callbackInstalled && validation != GL::Validation::Off) {
+        g_callbackInstalled = true;
+        glDebugMessageCallback(OnDebugMessage, nullptr);
+        // notifications are mostly buffer placement chatter
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE,
+                              GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr,
+                              GL_FALSE);
+    }
+
+    if (validation == GL::Validation::Off) {
+        glDisable(GL_DEBUG_OUTPUT);
+        return;
+    }
+    glEnable(GL_DEBUG_OUTPUT);
+    if (validation == GL::Validation::Async) {
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    } else {
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    }
+}
+
+void DrainErrors(const char* relation)
+{
+    const auto tier
+        = std::max(g_validation.load(std::memory_order_relaxed), g_scope);
+    if (tier != GL::Validation::Full) {
+        return;
+    }
+    for (GLenum error; (error = glGetError()) != GL_NO_ERROR;) {
+        g_stats.callErrors++;
+        SPDLOG_ERROR("GL error {:#x} {} '{}' at {}:{}{}", error, relation,
+                     g_callSite.call, g_callSite.file, g_callSite.line,
+                     g_scopeName ? std::format(" in {}", g_scopeName) : "");
+    }
+}
+
+} // namespace
+
+std::atomic<bool>           GL::Detail::g_checkCalls = false;
+constinit thread_local bool GL::Detail::g_scopeCheckCalls = false;
+
+const char* GL::ToString(Validation validation)
+{
+    switch (validation) {
+    case Validation::Off:
+        return "off";
+    case Validation::Async:
+        return "async";
+    case Validation::Sync:
+        return "sync";
+    case Validation::Full:
+        return "full";
+    default:
+        return "unknown";
+    }
+}
+
+bool GL::ParseValidation(std::string_view name, Validation& validation)
+{
+    for (const auto value : {Validation::Off, Validation::Async,
+                             Validation::Sync, Validation::Full}) {
+        if (name == ToString(value)) {
+            validation = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+void GL::SetValidation(Validation validation)
+{
+    g_validation.store(validation, std::memory_order_relaxed);
+    Detail::g_checkCalls.store(validation >= Validation::Sync,
+                               std::memory_order_relaxed);
+    Apply(std::max(validation, g_scope));
+}
+
+GL::Validation GL::GetValidation()
+{
+    return g_validation.load(std::memory_order_relaxed);
+}
+
+GL::ValidationScope::ValidationScope(Validation validation, const char* name)
+    : previous_(g_scope)
+    , previousName_(g_scopeName)
+{
+    g_scope = std::max(validation, previous_);
+    g_scopeName = name;
+    Detail::g_scopeCheckCalls = g_scope >= Validation::Sync;
+    Apply(std::max(g_scope, GetValidation()));
+}
+
+GL::ValidationScope::~ValidationScope()
+{
+    g_scope = previous_;
+    g_scopeName = previousName_;
+    Detail::g_scopeCheckCalls = previous_ >= Validation::Sync;
+    Apply(std::max(previous_, GetValidation()));
+}
+
+const GL::ValidationStats& GL::GetValidationStats() { return g_stats; }
+
+void GL::Detail::BeginCall(const char* call, const char* file, int line)
+{
+    g_callSite = {call, file, line};
+    // left by calls outside GL_CALL, they must not be blamed on this one
+    DrainErrors("before");
+}
+
+void GL::Detail::EndCall()
+{
+    DrainErrors("from");
+    g_callSite = {};
+}
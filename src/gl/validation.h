@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+namespace GL {
+
+// How much GL error checking runs, cheapest first; every tier includes the
+// ones before it.
+enum class Validation
+{
+    Off,   // no checks at all
+    Async, // KHR_debug callback, repeated messages are counted, not logged
+    Sync,  // synchronous debug output, messages name the GL_CALL in flight
+    Full,  // and glGetError() after every GL_CALL
+};
+
+const char* ToString(Validation validation);
+// off | async | sync | full
+bool ParseValidation(std::string_view name, Validation& validation);
+
+// The app's tier (--gl-validation). Needs the context; debug output needs
+// KHR_debug (GL 4.3), how much a non debug context reports is up to the
+// driver. Call site tracking and glGetError() are only compiled into
+// GL_CALL with OPENGL_DEBUG (CMake option GPLAY_GL_CALL_CHECKS), without it
+// Sync and Full report like Async but synchronously.
+void       SetValidation(Validation validation);
+Validation GetValidation();
+
+// Raises the tier for the commands of one canvas and names them in the
+// messages, see Canvas::SetGLValidation(). Never lowers the app's tier.
+// Created by the thread that holds the render context; the checks and names
+// only apply to the calls of that thread.
+class ValidationScope
+{
+public:
+    ValidationScope(Validation validation, const char* name);
+    ~ValidationScope();
+    ValidationScope(const ValidationScope&) = delete;
+    ValidationScope(ValidationScope&&) = delete;
+    ValidationScope& operator=(const ValidationScope&) = delete;
+    ValidationScope& operator=(ValidationScope&&) = delete;
+
+private:
+    Validation  previous_;
+    const char* previousName_;
+};
+
+// Readable from any thread.
+struct ValidationStats
+{
+    std::atomic<uint64_t> messages = 0;   // logged and deduplicated
+    std::atomic<uint64_t> duplicates = 0; // counted only
+    std::atomic<uint64_t> callErrors = 0; // glGetError() of GL_CALL
+};
+const ValidationStats& GetValidationStats();
+
+namespace Detail {
+// Sync and Full of the app and of the ValidationScope of the calling thread,
+// read by every GL_CALL.
+extern std::atomic<bool>           g_checkCalls;
+extern constinit thread_local bool g_scopeCheckCalls;
+
+void BeginCall(const char* call, const char* file, int line);
+void EndCall();
+} // namespace Detail
+
+} // namespace GL
@@ -0,0 +1,10 @@
+#pragma once
+
+// ImGui user config, included by imgui.h through IMGUI_USER_CONFIG.
+//
+// The current ImGui context is per thread, so the UI of several windows
+// (each with its own context) can be built at the same time. Any thread
+// that touches ImGui has to call ImGui::SetCurrentContext() first.
+struct ImGuiContext;
+extern thread_local ImGuiContext* g_imguiContext;
+#define GImGui g_imguiContext
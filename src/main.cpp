@@ -4,6 +4,8 @@
 int main(int argc, char** argv)
 {
     App app(argc, argv);
-    App::OpenWindow(new MainCanvas());
+    if (!App::IsBenchmark()) {
+        App::OpenWindow(new MainCanvas());
+    }
     return app.Exec();
 }
@@ -0,0 +1,85 @@
+#include "render_thread.h"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cassert>
+
+RenderThread::RenderThread(size_t depth)
+    : ring_(std::max<size_t>(depth, 1))
+{
+    thread_ = std::thread(&RenderThread::Main, this);
+}
+
+RenderThread::~RenderThread()
+{
+    assert(!acquired_);
+    Flush();
+    Submit([this] { quit_ = true; });
+    thread_.join();
+}
+
+void RenderThread::Submit(Packet packet)
+{
+    assert(!acquired_);
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    auto       head = head_.load(std::memory_order_acquire);
+    if (tail - head >= ring_.size()) {
+        const auto start = SDL_GetTicksNS();
+        while (tail - head >= ring_.size()) {
+            head_.wait(head, std::memory_order_acquire);
+            head = head_.load(std::memory_order_acquire);
+        }
+        ++stats_.fullWaits;
+        stats_.fullWaitNs += SDL_GetTicksNS() - start;
+    }
+
+    ring_[tail % ring_.size()] = std::move(packet);
+    tail_.store(tail + 1, std::memory_order_release);
+    tail_.notify_one();
+    ++stats_.packets;
+}
+
+void RenderThread::Acquire()
+{
+    assert(!acquired_);
+    Flush();
+    acquired_ = true;
+    ++stats_.handoffs;
+}
+
+void RenderThread::Release()
+{
+    assert(acquired_);
+    acquired_ = false;
+}
+
+// Queues a packet that releases the context and waits until it has run.
+void RenderThread::Flush()
+{
+    Submit([] { SDL_GL_MakeCurrent(nullptr, nullptr); });
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    auto       head = head_.load(std::memory_order_acquire);
+    while (head != tail) {
+        head_.wait(head, std::memory_order_acquire);
+        head = head_.load(std::memory_order_acquire);
+    }
+}
+
+void RenderThread::Main()
+{
+    auto head = head_.load(std::memory_order_relaxed);
+    while (!quit_) {
+        auto tail = tail_.load(std::memory_order_acquire);
+        while (head == tail) {
+            tail_.wait(tail, std::memory_order_acquire);
+            tail = tail_.load(std::memory_order_acquire);
+        }
+
+        auto& packet = ring_[head % ring_.size()];
+        packet();
+        packet = nullptr;
+        head_.store(++head, std::memory_order_release);
+        head_.notify_one();
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Thread that executes GL work recorded on the main thread. Packets go
+// through a bounded single-producer/single-consumer ring, so the main thread
+// can build frame N+1 while frame N is being submitted; Submit() only blocks
+// when Depth packets are already in flight.
+//
+// The GL context belongs to whoever runs GL work: packets make it current
+// on their windows themselves, and the main thread borrows it for work that
+// cannot be recorded with Acquire()/Release().
+class RenderThread
+{
+public:
+    using Packet = std::function<void()>;
+
+    struct Stats
+    {
+        uint64_t packets = 0;
+        uint64_t fullWaits = 0; // Submit() calls that found the queue full
+        uint64_t fullWaitNs = 0;
+        uint64_t handoffs = 0; // Acquire() calls
+    };
+
+    explicit RenderThread(size_t depth);
+    // Runs every queued packet, the context is released afterwards.
+    ~RenderThread();
+    RenderThread(const RenderThread&) = delete;
+    RenderThread(RenderThread&&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+    RenderThread& operator=(RenderThread&&) = delete;
+
+    size_t GetDepth() const { return ring_.size(); }
+
+    // Main thread only.
+    void Submit(Packet packet);
+    // Waits until every submitted packet has run and the render thread has
+    // released the context, the caller may make it current afterwards. No
+    // packets may be submitted until Release().
+    void Acquire();
+    void Release();
+
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    void Main();
+    void Flush();
+
+private:
+    std::vector<Packet>   ring_;
+    std::atomic<uint64_t> head_ = 0; // next packet to run, render thread
+    std::atomic<uint64_t> tail_ = 0; // next free slot, main thread
+    bool                  quit_ = false; // render thread only
+    bool                  acquired_ = false;
+    Stats                 stats_;
+    std::thread           thread_;
+};
@@ -0,0 +1,82 @@
+#include "frame_stats_overlay.h"
+#include "backends/imgui_impl_opengl3.h"
+#include "frame_pacer.h"
+#include "frame_stats.h"
+#include "gl/framework.h"
+#include "gl/program_cache.h"
+
+#include <imgui.h>
+
+void DrawFrameStatsOverlay(const FrameStats& stats, const FramePacer& pacer,
+                           const GL::ResourceStats& resources)
+{
+    static constexpr ImGuiWindowFlags windowFlags = ImGuiWindowFlags_NoDecoration
+        | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings
+        | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav
+        | ImGuiWindowFlags_NoDocking;
+    static constexpr ImGuiTableFlags tableFlags
+        = ImGuiTableFlags_BordersInner | ImGuiTableFlags_SizingFixedFit;
+
+    const auto* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(
+        ImVec2(viewport->Pos.x + viewport->Size.x - 10.0f, viewport->Pos.y + 10.0f),
+        ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.8f);
+    ImGui::Begin("##frame stats overlay", nullptr, windowFlags);
+
+    const auto& pacing = pacer.GetStats();
+    ImGui::Text("pacing: %s %.2f Hz", ToString(pacer.GetMode()), pacer.GetRate());
+    ImGui::Text("frames: %llu missed: %llu late: %llu",
+                (unsigned long long)pacing.frames,
+                (unsigned long long)pacing.missed,
+                (unsigned long long)pacing.lateFrames);
+    // the context is shared, so these cover all windows of the last frame
+    const auto stateChanges = GL::GetStateCache().GetLastFrameCounters();
+    ImGui::Text("gl state changes: %llu elided: %llu",
+                (unsigned long long)stateChanges.issued,
+                (unsigned long long)stateChanges.elided);
+    const auto uiDraws = ImGuiGLGetLastFrameStats();
+    ImGui::Text("ui draw commands: %llu draw calls: %llu (%s)",
+                (unsigned long long)uiDraws.commands,
+                (unsigned long long)uiDraws.drawCalls,
+                ImGuiGLIsBatching() ? "batched" : "unbatched");
+    ImGui::Text("gl objects: %lld (%.1f KiB) deleting: %lld",
+                (long long)resources.GetObjects(),
+                resources.GetBytes() / 1024.0,
+                (long long)resources.pending.load());
+    if (const auto* programCache = GL::GetProgramCache()) {
+        const auto& cache = programCache->GetStats();
+        ImGui::Text("program cache hits: %llu misses: %llu saved: %.1f ms",
+                    (unsigned long long)cache.hits.load(),
+                    (unsigned long long)cache.misses.load(),
+                    cache.savedNs.load() / 1e6);
+    }
+
+    if (ImGui::BeginTable("##frame stats", 5, tableFlags)) {
+        ImGui::TableSetupColumn("stage, ms");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("max");
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < (size_t)FrameStage::Count; ++i) {
+            const auto stage = (FrameStage)i;
+            const auto summary = stats.Summarize(stage);
+            if (summary.count == 0) {
+                continue;
+            }
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(ToString(stage));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", summary.p50);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", summary.p95);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", summary.p99);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", summary.max);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
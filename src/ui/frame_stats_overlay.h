@@ -0,0 +1,13 @@
+#pragma once
+
+class FrameStats;
+class FramePacer;
+namespace GL {
+struct ResourceStats;
+}
+
+// Small always-on-top table with per-stage p50/p95/p99/max timings of the
+// current window, with the GL objects of its canvas. Must be called between
+// ImGui::NewFrame and ImGui::Render.
+void DrawFrameStatsOverlay(const FrameStats& stats, const FramePacer& pacer,
+                           const GL::ResourceStats& resources);
@@ -0,0 +1,77 @@
+#include "worker_pool.h"
+
+#include <cassert>
+
+WorkerPool::WorkerPool(size_t threads)
+{
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back(&WorkerPool::WorkerMain, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    Wait();
+    {
+        std::lock_guard lock(mutex_);
+        quit_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkerPool::Dispatch(size_t count, Job job)
+{
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+
+    job_ = std::move(job);
+    count_ = count;
+    next_ = 0;
+    ++batch_;
+    pending_ = threads_.size();
+    lock.unlock();
+    wake_.notify_all();
+}
+
+void WorkerPool::Wait()
+{
+    if (job_) {
+        Work();
+    }
+
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+    job_ = nullptr;
+}
+
+void WorkerPool::WorkerMain()
+{
+    uint64_t         batch = 0;
+    std::unique_lock lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return quit_ || batch_ != batch; });
+        if (quit_) {
+            return;
+        }
+        batch = batch_;
+
+        lock.unlock();
+        Work();
+        lock.lock();
+
+        assert(pending_ > 0);
+        if (--pending_ == 0) {
+            done_.notify_all();
+        }
+    }
+}
+
+void WorkerPool::Work()
+{
+    for (auto i = next_.fetch_add(1); i < count_; i = next_.fetch_add(1)) {
+        job_(i);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads running one parallel-for batch at a time. Dispatch()
+// hands the items to the workers and returns immediately, so the caller can
+// do other work; Wait() joins in on the remaining items and returns once the
+// whole batch is done.
+class WorkerPool
+{
+public:
+    using Job = std::function<void(size_t)>;
+
+    explicit WorkerPool(size_t threads);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool(WorkerPool&&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    WorkerPool& operator=(WorkerPool&&) = delete;
+
+    size_t GetThreadCount() const { return threads_.size(); }
+
+    void Dispatch(size_t count, Job job);
+    void Wait();
+
+private:
+    void WorkerMain();
+    void Work();
+
+private:
+    std::vector<std::thread> threads_;
+    std::mutex               mutex_;
+    std::condition_variable  wake_;
+    std::condition_variable  done_;
+    bool                     quit_ = false;
+
+    // the batch only changes while no worker is inside it (pending_ == 0)
+    Job                 job_;
+    size_t              count_ = 0;
+    std::atomic<size_t> next_ = 0;
+    uint64_t            batch_ = 0;
+    size_t              pending_ = 0; // workers that have not finished it yet
+};
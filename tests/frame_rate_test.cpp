@@ -1,4 +1,5 @@
 #include <SDL3/SDL.h>
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <cstdio>
@@ -6,16 +7,49 @@
 #include <glad/glad.h>
 #include <spdlog/spdlog.h>
 #include <string_view>
+#include <vector>
 
-constexpr int g_count = 1;
+// Measures how the frame rate scales with the number of windows sharing one
+// GL context for each presentation strategy:
+//
+//   frame_rate_test [max windows] [sequential|vsync-last|composite|all]
+//                   [seconds per run]
+//
+// sequential  - every window swaps with interval 1 (one vblank per window)
+// vsync-last  - only the last window swaps with interval 1
+// composite   - every window renders into an FBO first, then all of them are
+//               blitted and swapped, the last one with interval 1
 
-SDL_Window* CreateWindow(std::string_view title)
+enum class Mode
+{
+    Sequential,
+    VSyncLast,
+    Composite,
+};
+
+constexpr std::array g_modes
+    = { Mode::Sequential, Mode::VSyncLast, Mode::Composite };
+
+const char* ToString(Mode mode)
+{
+    switch (mode) {
+    case Mode::Sequential:
+        return "sequential";
+    case Mode::VSyncLast:
+        return "vsync-last";
+    case Mode::Composite:
+        return "composite";
+    }
+    return "";
+}
+
+SDL_Window* CreateWindow(std::string_view title, SDL_WindowFlags flags = 0)
 {
     auto* window = SDL_CreateWindow(title.data(), 800, 200,
                                     SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE
-                                        | SDL_WINDOW_TRANSPARENT);
+                                        | SDL_WINDOW_TRANSPARENT | flags);
     if (window == nullptr) {
-        spdlog::error("Error: SDL_CreateWindow(): %s\n", SDL_GetError());
+        spdlog::error("Error: SDL_CreateWindow(): {}", SDL_GetError());
         SDL_Quit();
         exit(1);
     }
@@ -23,12 +57,142 @@ SDL_Window* CreateWindow(std::string_view title)
     return window;
 }
 
-int main()
+struct Target
+{
+    GLuint fbo = 0;
+    GLuint color = 0;
+};
+
+Target CreateTarget(int width, int height)
+{
+    Target target;
+    glCreateRenderbuffers(1, &target.color);
+    glNamedRenderbufferStorage(target.color, GL_RGBA8, width, height);
+    glCreateFramebuffers(1, &target.fbo);
+    glNamedFramebufferRenderbuffer(target.fbo, GL_COLOR_ATTACHMENT0,
+                                   GL_RENDERBUFFER, target.color);
+    return target;
+}
+
+void DestroyTarget(Target& target)
+{
+    glDeleteFramebuffers(1, &target.fbo);
+    glDeleteRenderbuffers(1, &target.color);
+    target = {};
+}
+
+void Swap(SDL_Window* window, int interval, int& currentInterval)
+{
+    if (currentInterval != interval) {
+        SDL_GL_SetSwapInterval(interval);
+        currentInterval = interval;
+    }
+    SDL_GL_SwapWindow(window);
+}
+
+// Returns the average frame rate of count windows presented with mode.
+double Run(SDL_GLContext glContext, Mode mode, int count, double seconds)
+{
+    std::vector<SDL_Window*> windows(count);
+    std::vector<Target>      targets(count);
+    std::vector<int>         intervals(count, -1);
+    for (int i = 0; i < count; ++i) {
+        windows[i] = CreateWindow("frame_rate_test");
+        SDL_SetWindowPosition(windows[i], 100 + 40 * i, 100 + 40 * i);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const auto duration = std::chrono::duration<double>(seconds);
+    uint64_t   frames = 0;
+
+    bool done = false;
+    while (!done && Clock::now() - start < duration) {
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_EVENT_QUIT
+                || event.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED) {
+                done = true;
+            }
+        }
+
+        const auto last = count - 1;
+        for (int i = 0; i < count; ++i) {
+            auto* window = windows[i];
+            SDL_GL_MakeCurrent(window, glContext);
+
+            int width = 0;
+            int height = 0;
+            SDL_GetWindowSizeInPixels(window, &width, &height);
+            if (mode == Mode::Composite) {
+                if (!targets[i].fbo) {
+                    targets[i] = CreateTarget(width, height);
+                }
+                glBindFramebuffer(GL_FRAMEBUFFER, targets[i].fbo);
+            }
+            glViewport(0, 0, width, height);
+            glClearColor(0.1f, 0.6f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            if (mode == Mode::Sequential) {
+                Swap(window, 1, intervals[i]);
+            } else if (mode == Mode::VSyncLast) {
+                Swap(window, i == last ? 1 : 0, intervals[i]);
+            }
+        }
+
+        if (mode == Mode::Composite) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            for (int i = 0; i < count; ++i) {
+                int width = 0;
+                int height = 0;
+                SDL_GetWindowSizeInPixels(windows[i], &width, &height);
+                SDL_GL_MakeCurrent(windows[i], glContext);
+                glBlitNamedFramebuffer(targets[i].fbo, 0, 0, 0, width, height,
+                                       0, 0, width, height,
+                                       GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                Swap(windows[i], i == last ? 1 : 0, intervals[i]);
+            }
+        }
+        ++frames;
+    }
+
+    const auto elapsed
+        = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (int i = 0; i < count; ++i) {
+        SDL_GL_MakeCurrent(windows[i], glContext);
+        DestroyTarget(targets[i]);
+    }
+    SDL_GL_MakeCurrent(nullptr, nullptr);
+    for (auto* window : windows) {
+        SDL_DestroyWindow(window);
+    }
+
+    return done ? 0.0 : frames / elapsed;
+}
+
+int main(int argc, char** argv)
 {
-    std::array<SDL_Window*, g_count> windows;
+    int    maxCount = argc > 1 ? std::atoi(argv[1]) : 5;
+    double seconds = argc > 3 ? std::atof(argv[3]) : 3.0;
+    std::vector<Mode> modes(g_modes.begin(), g_modes.end());
+    if (argc > 2 && std::string_view(argv[2]) != "all") {
+        modes.clear();
+        for (auto mode : g_modes) {
+            if (argv[2] == std::string_view(ToString(mode))) {
+                modes.push_back(mode);
+            }
+        }
+        if (modes.empty()) {
+            spdlog::error("Error: unknown mode '{}'", argv[2]);
+            exit(1);
+        }
+    }
+    maxCount = std::max(maxCount, 1);
 
     if (!SDL_Init(SDL_INIT_VIDEO)) {
-        spdlog::error("Error: SDL_Init(): %s\n", SDL_GetError());
+        spdlog::error("Error: SDL_Init(): {}", SDL_GetError());
         exit(1);
     }
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
@@ -39,75 +203,42 @@ int main()
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
     SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
-    SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
-    SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 8);
     SDL_GL_SetAttribute(SDL_GL_ACCELERATED_VISUAL, 1);
+    // SDL_GL_MULTISAMPLEBUFFERS/SAMPLES are left unset: composite blits into
+    // the back buffers, which a multisampled one would not accept
 
-    for (size_t i = 0; i < g_count; ++i) {
-        windows[i] = CreateWindow("frame_rate_test");
-        SDL_SetWindowPosition(windows[i], 100, 100 + 200 * i);
-    }
-
-    SDL_GLContext glContext = SDL_GL_CreateContext(windows[0]);
+    // windows come and go between runs, the context lives on a hidden one
+    auto* contextWindow = CreateWindow("frame_rate_test", SDL_WINDOW_HIDDEN);
+    SDL_GLContext glContext = SDL_GL_CreateContext(contextWindow);
     if (glContext == nullptr) {
-        spdlog::error("Error: SDL_GL_CreateContext(): %s\n", SDL_GetError());
+        spdlog::error("Error: SDL_GL_CreateContext(): {}", SDL_GetError());
         SDL_Quit();
         exit(1);
     }
 
-    SDL_GL_MakeCurrent(windows[0], glContext);
+    SDL_GL_MakeCurrent(contextWindow, glContext);
     if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
-        spdlog::error("Error: gladLoadGLLoader() failed\n");
+        spdlog::error("Error: gladLoadGLLoader() failed");
         SDL_Quit();
         exit(1);
     }
 
-    SDL_GL_SetSwapInterval(1);
-
-    auto getTicksMs = []() {
-        using Clock = std::chrono::high_resolution_clock;
-        using Ms = std::chrono::milliseconds;
-        return std::chrono::duration_cast<Ms>(Clock::now().time_since_epoch())
-            .count();
-    };
-    constexpr auto frameLength = 16;
-    uint64_t       nextFrameStart = getTicksMs() + frameLength;
-    bool           frameRendered = false;
-
-    bool done = false;
-    while (!done) {
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_EVENT_QUIT
-                || event.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED) {
-                done = true;
-            }
-        }
-
-        auto t = getTicksMs();
-        if (t > nextFrameStart) {
-            nextFrameStart += frameLength;
-            frameRendered = false;
-        }
-
-        if (!frameRendered) {
-            for (size_t i = 0; i < g_count; ++i) {
-                auto* window = windows[i];
-                SDL_GL_MakeCurrent(window, glContext);
-                glClearColor(0.1f, 0.6f, 0.3f, 1.0f);
-                glClear(GL_COLOR_BUFFER_BIT);
-                SDL_GL_SwapWindow(window);
+    std::printf("%-12s %8s %10s\n", "mode", "windows", "fps");
+    for (auto mode : modes) {
+        for (int count = 1; count <= maxCount; ++count) {
+            const auto fps = Run(glContext, mode, count, seconds);
+            if (fps == 0.0) {
+                break; // closed by the user
             }
-            frameRendered = true;
+            std::printf("%-12s %8d %10.1f\n", ToString(mode), count, fps);
+            std::fflush(stdout);
         }
     }
 
     SDL_GL_MakeCurrent(nullptr, nullptr);
     SDL_GL_DestroyContext(glContext);
-    for (size_t i = 0; i < g_count; ++i) {
-        SDL_DestroyWindow(windows[i]);
-    }
+    SDL_DestroyWindow(contextWindow);
     SDL_Quit();
 
     return 0;
-}
\ No newline at end of file
+}